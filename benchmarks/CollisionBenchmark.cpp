@@ -0,0 +1,179 @@
+// Compares CollisionSystem's spatial hash broadphase with the previous test
+// of every collider pair, on a field of units and bullets among static
+// colliders, and checks that both queue the same collisions in the same
+// order. Build with `make bench` and run ./out/benchmarks/CollisionBenchmark.
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/Components/BoxColliderComponent.h"
+#include "../src/Components/RigidBodyComponent.h"
+#include "../src/Components/TransformComponent.h"
+#include "../src/ECS/ECS.h"
+#include "../src/EventBus/EventBus.h"
+#include "../src/Events/CollisionEvent.h"
+#include "../src/Systems/CollisionSystem.h"
+
+// The previous CollisionSystem, kept here as the baseline.
+class PairwiseCollisionSystem : public System {
+ public:
+  PairwiseCollisionSystem() {
+    RequireComponent<TransformComponent>();
+    RequireComponent<BoxColliderComponent>();
+  }
+
+  void SetEventQueue(EventQueue& eventQueue) {
+    this->eventQueue = &eventQueue;
+  }
+
+  void Update(std::unique_ptr<Registry>& registry) {
+    colliders.clear();
+    auto gather = [this](Entity entity, const TransformComponent& transform,
+                         const BoxColliderComponent& collider) {
+      colliders.push_back({entity.GetHandle(),
+                           transform.position + collider.offset,
+                           glm::vec2(collider.width, collider.height)});
+    };
+    registry
+        ->GetComponentGroup<TransformComponent, RigidBodyComponent,
+                            BoxColliderComponent>()
+        .Each([&gather](Entity entity, const TransformComponent& transform,
+                        const RigidBodyComponent&,
+                        const BoxColliderComponent& collider) {
+          gather(entity, transform, collider);
+        });
+    registry
+        ->View<TransformComponent, BoxColliderComponent>(
+            Exclude<RigidBodyComponent>())
+        .Each(gather);
+
+    for (auto a = colliders.begin(); a != colliders.end(); a++) {
+      for (auto b = a + 1; b != colliders.end(); b++) {
+        if (CollisionUtil::CheckAABBCollision(a->position, a->size,
+                                              b->position, b->size)) {
+          eventQueue->Queue<CollisionEvent>(a->entity, b->entity);
+        }
+      }
+    }
+  }
+
+ private:
+  struct Collider {
+    EntityHandle entity;
+    glm::vec2 position;
+    glm::vec2 size;
+  };
+
+  std::vector<Collider> colliders;
+  EventQueue* eventQueue = nullptr;
+};
+
+// Takes the collisions queued since the last call.
+std::vector<CollisionEvent> TakeCollisions(EventQueue& eventQueue) {
+  std::vector<CollisionEvent> collisions;
+  if (auto buffer = static_cast<EventBuffer<CollisionEvent>*>(
+          eventQueue.GetBuffer(EventType<CollisionEvent>::GetId()))) {
+    std::swap(collisions, buffer->events);
+  }
+  return collisions;
+}
+
+bool IsSameOrder(const std::vector<CollisionEvent>& a,
+                 const std::vector<CollisionEvent>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].a != b[i].a || a[i].b != b[i].b) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename TFunction>
+double MeasureMillisPerFrame(int numFrames, TFunction function) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < numFrames; frame++) {
+    function();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         numFrames;
+}
+
+// A quarter of the colliders are static 32x32 blocks, the rest units of the
+// same size and 4x4 bullets. The field keeps the density of a busy level:
+// about one collider per 64x64 pixels.
+void RunBenchmark(size_t numColliders, int numPairwiseFrames) {
+  // The registry logs every structural change; keep it off the console.
+  std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+  auto registry = std::make_unique<Registry>();
+  auto eventBus = std::make_unique<EventBus>();
+  registry->AddSystem<CollisionSystem>();
+  registry->AddSystem<PairwiseCollisionSystem>();
+  auto& collisionSystem = registry->GetSystem<CollisionSystem>();
+  auto& pairwiseSystem = registry->GetSystem<PairwiseCollisionSystem>();
+  EventQueue& collisionQueue = eventBus->CreateEventQueue();
+  EventQueue& pairwiseQueue = eventBus->CreateEventQueue();
+  collisionSystem.SetEventQueue(collisionQueue);
+  pairwiseSystem.SetEventQueue(pairwiseQueue);
+
+  std::mt19937 random(42);
+  const float fieldSize = 64.0f * std::sqrt(static_cast<float>(numColliders));
+  std::uniform_real_distribution<float> position(0, fieldSize);
+  for (size_t i = 0; i < numColliders; i++) {
+    Entity entity = registry->CreateEntity();
+    entity.AddComponent<TransformComponent>(
+        glm::vec2(position(random), position(random)));
+    if (i % 4 == 0) {
+      entity.AddComponent<BoxColliderComponent>(32, 32);
+    } else if (i % 4 == 1) {
+      entity.AddComponent<BoxColliderComponent>(32, 32);
+      entity.AddComponent<RigidBodyComponent>(glm::vec2(30, 0));
+    } else {
+      entity.AddComponent<BoxColliderComponent>(4, 4);
+      entity.AddComponent<RigidBodyComponent>(glm::vec2(0, 300));
+    }
+  }
+  registry->Update();
+  std::cout.rdbuf(coutBuffer);
+
+  collisionSystem.Update(registry);
+  pairwiseSystem.Update(registry);
+  const std::vector<CollisionEvent> collisions = TakeCollisions(collisionQueue);
+  const bool isSame = IsSameOrder(collisions, TakeCollisions(pairwiseQueue));
+  std::cout << numColliders << " colliders, " << collisions.size()
+            << " collisions, " << (isSame ? "same" : "DIFFERENT")
+            << " collisions from both" << std::endl;
+
+  const double gridMillis = MeasureMillisPerFrame(50, [&]() {
+    collisionSystem.Update(registry);
+    TakeCollisions(collisionQueue);
+  });
+  std::cout << "  spatial hash: " << gridMillis << " ms/frame, "
+            << collisionSystem.GetTestCount() << " tests" << std::endl;
+  const double pairwiseMillis =
+      MeasureMillisPerFrame(numPairwiseFrames, [&]() {
+        pairwiseSystem.Update(registry);
+        TakeCollisions(pairwiseQueue);
+      });
+  std::cout << "  every pair: " << pairwiseMillis << " ms/frame, "
+            << numColliders * (numColliders - 1) / 2 << " tests" << std::endl;
+
+  std::cout.rdbuf(nullptr);
+  registry.reset();
+  eventBus.reset();
+  std::cout.rdbuf(coutBuffer);
+}
+
+int main() {
+  RunBenchmark(5000, 10);
+  RunBenchmark(50000, 1);
+  return 0;
+}
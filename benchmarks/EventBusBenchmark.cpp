@@ -0,0 +1,262 @@
+// Counts heap allocations and time per frame for delivering a frame's worth
+// of collision events: through the previous map-and-list EventBus, with and
+// without resubscribing every frame as Game::Update used to, through
+// EmitEvent, and queued and drained as one batch, also with tracing and
+// with tracing and recording turned on. Then compares producers
+// on several threads sharing a mutex-guarded vector with each filling its
+// own EventQueue. Build with `make bench` and run
+// ./out/benchmarks/EventBusBenchmark.
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <vector>
+
+#include "../src/EventBus/EventBus.h"
+#include "../src/Events/CollisionEvent.h"
+
+namespace {
+size_t allocationCount = 0;
+}
+
+void* operator new(size_t size) {
+  allocationCount++;
+  if (void* memory = std::malloc(size ? size : 1)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+// The previous EventBus, kept here as the baseline: a map lookup per
+// emission, a fresh event per handler and one heap-allocated callback and
+// list node per subscription.
+class IEventCallback {
+ public:
+  virtual ~IEventCallback() = default;
+  void Execute(Event& e) { Call(e); }
+
+ private:
+  virtual void Call(Event& e) = 0;
+};
+
+template <typename TOwner, typename TEvent>
+class EventCallback : public IEventCallback {
+  typedef void (TOwner::*CallbackFunction)(TEvent&);
+
+ public:
+  EventCallback(TOwner* ownerInstance, CallbackFunction callbackFunction) {
+    this->ownerInstance = ownerInstance;
+    this->callbackFunction = callbackFunction;
+  }
+
+ private:
+  virtual void Call(Event& e) override {
+    std::invoke(callbackFunction, ownerInstance, static_cast<TEvent&>(e));
+  }
+
+ private:
+  TOwner* ownerInstance;
+  CallbackFunction callbackFunction;
+};
+
+typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
+
+class MapEventBus {
+ public:
+  void Reset() { subscribers.clear(); }
+
+  template <typename TEvent, typename TOwner>
+  void SubscribeToEvent(TOwner* ownerInstance,
+                        void (TOwner::*callbackFunction)(TEvent&)) {
+    if (!subscribers[typeid(TEvent)].get()) {
+      subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
+    }
+    subscribers[typeid(TEvent)]->push_back(
+        std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance,
+                                                        callbackFunction));
+  }
+
+  template <typename TEvent, typename... TArgs>
+  void EmitEvent(TArgs&&... args) {
+    auto handlers = subscribers[typeid(TEvent)].get();
+    if (handlers) {
+      for (auto it = handlers->begin(); it != handlers->end(); it++) {
+        TEvent event(std::forward<TArgs>(args)...);
+        it->get()->Execute(event);
+      }
+    }
+  }
+
+ private:
+  std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers;
+};
+
+struct DamageCounter {
+  size_t hits = 0;
+
+  void OnCollision(CollisionEvent& event) { hits += event.a.GetIndex() & 1; }
+
+  void OnCollisions(EventSpan<CollisionEvent> events) {
+    for (auto& event : events) {
+      OnCollision(event);
+    }
+  }
+};
+
+const int NUM_FRAMES = 100;
+
+template <typename TFrame>
+void RunBenchmark(const std::string& name, size_t eventsPerFrame,
+                  TFrame frame) {
+  frame(eventsPerFrame);  // Warm-up: buffers grow to the frame's size.
+  const size_t allocationsBefore = allocationCount;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < NUM_FRAMES; i++) {
+    frame(eventsPerFrame);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  std::cout << name << ": "
+            << std::chrono::duration<double, std::micro>(end - start).count() /
+                   NUM_FRAMES
+            << " us/frame, "
+            << (allocationCount - allocationsBefore) / NUM_FRAMES
+            << " allocations/frame" << std::endl;
+}
+
+// Runs produce(thread index) on each of numThreads threads per frame.
+template <typename TProduce, typename TConsume>
+void RunThreadedBenchmark(const std::string& name, size_t numThreads,
+                          TProduce produce, TConsume consume) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; i++) {
+      threads.emplace_back(produce, i);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    consume();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  std::cout << name << ": "
+            << std::chrono::duration<double, std::micro>(end - start).count() /
+                   NUM_FRAMES
+            << " us/frame" << std::endl;
+}
+
+int main() {
+  // The buses log construction; keep that off the console.
+  std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+  DamageCounter counter;
+  MapEventBus mapBus;
+  mapBus.SubscribeToEvent<CollisionEvent>(&counter,
+                                          &DamageCounter::OnCollision);
+  auto emitBus = std::make_unique<EventBus>();
+  emitBus->SubscribeToEvent<CollisionEvent>(&counter,
+                                            &DamageCounter::OnCollision);
+  auto queueBus = std::make_unique<EventBus>();
+  queueBus->SubscribeToEventBatch<CollisionEvent>(
+      &counter, &DamageCounter::OnCollisions);
+  std::cout.rdbuf(coutBuffer);
+
+  const size_t eventsPerFrame = 5000;
+  std::cout << eventsPerFrame << " collisions/frame" << std::endl;
+  RunBenchmark("map and list", eventsPerFrame, [&](size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      mapBus.EmitEvent<CollisionEvent>(EntityHandle(i, 0),
+                                       EntityHandle(i + 1, 0));
+    }
+  });
+  RunBenchmark("map and list, resubscribed", eventsPerFrame,
+               [&](size_t count) {
+                 mapBus.Reset();
+                 mapBus.SubscribeToEvent<CollisionEvent>(
+                     &counter, &DamageCounter::OnCollision);
+                 for (size_t i = 0; i < count; i++) {
+                   mapBus.EmitEvent<CollisionEvent>(EntityHandle(i, 0),
+                                                    EntityHandle(i + 1, 0));
+                 }
+               });
+  RunBenchmark("EmitEvent", eventsPerFrame, [&](size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      emitBus->EmitEvent<CollisionEvent>(EntityHandle(i, 0),
+                                         EntityHandle(i + 1, 0));
+    }
+  });
+  RunBenchmark("QueueEvent", eventsPerFrame, [&](size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      queueBus->QueueEvent<CollisionEvent>(EntityHandle(i, 0),
+                                           EntityHandle(i + 1, 0));
+    }
+    queueBus->DispatchQueuedEvents();
+  });
+  auto traceQueuedEvents = [&](size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      queueBus->QueueEvent<CollisionEvent>(EntityHandle(i, 0),
+                                           EntityHandle(i + 1, 0));
+    }
+    queueBus->DispatchQueuedEvents();
+    queueBus->EndTraceFrame();
+  };
+  queueBus->EnableTracing();
+  RunBenchmark("QueueEvent, tracing", eventsPerFrame, traceQueuedEvents);
+  queueBus->EnableTracing(64 * 1024);
+  RunBenchmark("QueueEvent, tracing and recording", eventsPerFrame,
+               traceQueuedEvents);
+  queueBus->DisableTracing();
+
+  const size_t numThreads = 4;
+  const size_t eventsPerThread = 20000;
+  std::cout << numThreads << " producer threads, " << eventsPerThread
+            << " events each" << std::endl;
+  std::mutex mutex;
+  std::vector<CollisionEvent> sharedEvents;
+  RunThreadedBenchmark(
+      "shared vector with mutex", numThreads,
+      [&](size_t thread) {
+        for (size_t i = 0; i < eventsPerThread; i++) {
+          std::lock_guard<std::mutex> lock(mutex);
+          sharedEvents.emplace_back(EntityHandle(thread, 0),
+                                    EntityHandle(i, 0));
+        }
+      },
+      [&]() {
+        counter.OnCollisions(EventSpan<CollisionEvent>(sharedEvents.data(),
+                                                       sharedEvents.size()));
+        sharedEvents.clear();
+      });
+  std::vector<EventQueue*> eventQueues;
+  for (size_t i = 0; i < numThreads; i++) {
+    eventQueues.push_back(&queueBus->CreateEventQueue());
+  }
+  RunThreadedBenchmark(
+      "EventQueue per thread", numThreads,
+      [&](size_t thread) {
+        for (size_t i = 0; i < eventsPerThread; i++) {
+          eventQueues[thread]->Queue<CollisionEvent>(EntityHandle(thread, 0),
+                                                     EntityHandle(i, 0));
+        }
+      },
+      [&]() { queueBus->DispatchQueuedEvents(); });
+  std::cout << "(hits " << counter.hits << ")" << std::endl;
+
+  std::cout.rdbuf(nullptr);
+  emitBus.reset();
+  queueBus.reset();
+  std::cout.rdbuf(coutBuffer);
+  return 0;
+}
@@ -0,0 +1,122 @@
+// Compares the sparse-set Pool<T> against the hash-map pool it replaced.
+// Build with `make bench` and run ./out/benchmarks/PoolBenchmark.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "../src/Components/TransformComponent.h"
+#include "../src/ECS/ECS.h"
+
+// The previous Pool<T> implementation, kept here as the baseline.
+template <typename T>
+class MapPool {
+ public:
+  MapPool(size_t capacity = 100) {
+    size = 0;
+    data.resize(capacity);
+  }
+
+  void Set(size_t entityId, T object) {
+    if (entityIdToIndex.find(entityId) != entityIdToIndex.end()) {
+      int index = entityIdToIndex[entityId];
+      data[index] = object;
+    } else {
+      int index = size;
+      entityIdToIndex.emplace(entityId, index);
+      indexToEntityId.emplace(index, entityId);
+      if (static_cast<long unsigned int>(index) >= data.capacity()) {
+        data.resize(data.capacity() * 2);
+      }
+      data[index] = object;
+      size++;
+    }
+  }
+
+  void Remove(int entityId) {
+    int indexOfRemoved = entityIdToIndex[entityId];
+    int indexOfLast = size - 1;
+    data[indexOfRemoved] = data[indexOfLast];
+
+    int entityIdOfLastElement = indexToEntityId[indexOfLast];
+    entityIdToIndex[entityIdOfLastElement] = indexOfRemoved;
+    indexToEntityId[indexOfRemoved] = entityIdOfLastElement;
+
+    entityIdToIndex.erase(entityId);
+    indexToEntityId.erase(indexOfLast);
+
+    size--;
+  }
+
+  T& Get(size_t entityId) { return data[entityIdToIndex[entityId]]; }
+
+ private:
+  std::vector<T> data;
+  int size;
+
+  std::unordered_map<int, int> entityIdToIndex;
+  std::unordered_map<int, int> indexToEntityId;
+};
+
+template <typename TFunction>
+double MeasureNanosPerOp(size_t operations, TFunction function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         operations;
+}
+
+template <typename TPool>
+void RunBenchmark(const std::string& name, const std::vector<size_t>& ids,
+                  const std::vector<size_t>& lookups) {
+  TPool pool;
+  float checksum = 0;
+
+  const double set = MeasureNanosPerOp(ids.size(), [&]() {
+    for (auto id : ids) {
+      pool.Set(id, TransformComponent(glm::vec2(id, id)));
+    }
+  });
+  const double get = MeasureNanosPerOp(lookups.size(), [&]() {
+    for (auto id : lookups) {
+      checksum += pool.Get(id).position.x;
+    }
+  });
+  const double remove = MeasureNanosPerOp(ids.size() / 2, [&]() {
+    for (size_t i = 0; i < ids.size() / 2; i++) {
+      pool.Remove(ids[i]);
+    }
+  });
+
+  std::cout << name << ": set " << set << " ns, get " << get
+            << " ns, remove " << remove << " ns (checksum " << checksum
+            << ")" << std::endl;
+}
+
+int main() {
+  const size_t numEntities = 100000;
+  const size_t numLookups = 1000000;
+
+  std::mt19937 random(42);
+  std::vector<size_t> ids(numEntities);
+  std::iota(ids.begin(), ids.end(), 0);
+  std::shuffle(ids.begin(), ids.end(), random);
+
+  std::vector<size_t> lookups(numLookups);
+  std::uniform_int_distribution<size_t> pick(0, numEntities - 1);
+  for (auto& id : lookups) {
+    id = ids[pick(random)];
+  }
+
+  std::cout << numEntities << " entities, " << numLookups << " lookups"
+            << std::endl;
+  RunBenchmark<MapPool<TransformComponent>>("unordered_map pool", ids,
+                                            lookups);
+  RunBenchmark<Pool<TransformComponent>>("sparse set pool", ids, lookups);
+  return 0;
+}
@@ -0,0 +1,68 @@
+// Compares spawning entities component by component with AddComponent
+// against cloning a prefab, one at a time and in bulk. Build with
+// `make bench` and run ./out/benchmarks/PrefabBenchmark.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "../src/Components/BoxColliderComponent.h"
+#include "../src/Components/HealthComponent.h"
+#include "../src/Components/RigidBodyComponent.h"
+#include "../src/Components/TransformComponent.h"
+#include "../src/ECS/ECS.h"
+
+template <typename TFunction>
+void RunBenchmark(const std::string& name, size_t numEntities,
+                  TFunction spawn) {
+  // The registry logs every structural change; keep it off the console.
+  std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+  auto registry = std::make_unique<Registry>();
+  PrefabId prefab = registry->CreatePrefab();
+  registry->AddPrefabComponent<TransformComponent>(prefab);
+  registry->AddPrefabComponent<RigidBodyComponent>(prefab, glm::vec2(0, 50));
+  registry->AddPrefabComponent<BoxColliderComponent>(prefab, 4, 4);
+  registry->AddPrefabComponent<HealthComponent>(prefab, 100);
+
+  const auto start = std::chrono::steady_clock::now();
+  spawn(*registry, prefab, numEntities);
+  registry->Update();
+  const auto end = std::chrono::steady_clock::now();
+  float checksum = 0;
+  registry->View<RigidBodyComponent>().Each(
+      [&checksum](RigidBodyComponent& body) { checksum += body.velocity.y; });
+
+  registry.reset();
+  std::cout.rdbuf(coutBuffer);
+  std::cout << name << ": "
+            << std::chrono::duration<double, std::nano>(end - start).count() /
+                   numEntities
+            << " ns/entity (checksum " << checksum << ")" << std::endl;
+}
+
+int main() {
+  const size_t numEntities = 100000;
+  RunBenchmark("AddComponent", numEntities,
+               [](Registry& registry, PrefabId, size_t count) {
+                 for (size_t i = 0; i < count; i++) {
+                   Entity entity = registry.CreateEntity();
+                   entity.AddComponent<TransformComponent>();
+                   entity.AddComponent<RigidBodyComponent>(glm::vec2(0, 50));
+                   entity.AddComponent<BoxColliderComponent>(4, 4);
+                   entity.AddComponent<HealthComponent>(100);
+                 }
+               });
+  RunBenchmark("Instantiate", numEntities,
+               [](Registry& registry, PrefabId prefab, size_t count) {
+                 for (size_t i = 0; i < count; i++) {
+                   registry.Instantiate(prefab);
+                 }
+               });
+  RunBenchmark("InstantiateMany", numEntities,
+               [](Registry& registry, PrefabId prefab, size_t count) {
+                 registry.InstantiateMany(prefab, count);
+               });
+  return 0;
+}
@@ -0,0 +1,116 @@
+// Compares the old render pass, which copied every sprite and transform
+// and sorted the copies each frame, with walking a sprite pool kept sorted
+// by Registry::SortComponents. Build with `make bench` and run
+// ./out/benchmarks/RenderOrderBenchmark.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/Components/TransformComponent.h"
+#include "../src/ECS/ECS.h"
+
+// Same shape as SpriteComponent, which needs the SDL headers.
+struct SpriteLikeComponent {
+  std::string assetId;
+  size_t zIndex;
+  int width;
+  int height;
+
+  SpriteLikeComponent(std::string assetId = "", size_t zIndex = 0)
+      : assetId(assetId), zIndex(zIndex), width(32), height(32) {}
+};
+
+bool IsDrawnBefore(const SpriteLikeComponent& a,
+                   const SpriteLikeComponent& b) {
+  return a.zIndex < b.zIndex;
+}
+
+const int NUM_FRAMES = 100;
+
+void RunBenchmark(size_t numSprites, size_t spawnsPerFrame) {
+  // The registry logs every structural change; keep it off the console.
+  std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+  auto registry = std::make_unique<Registry>();
+  std::mt19937 random(42);
+  std::vector<Entity> entities = registry->CreateEntities(numSprites);
+  std::vector<SpriteLikeComponent> sprites;
+  for (size_t i = 0; i < numSprites; i++) {
+    sprites.emplace_back("tilemap-image", random() % 5);
+  }
+  registry->AddComponents(entities, std::move(sprites));
+  registry->AddComponents(entities, std::vector<TransformComponent>(
+                                        numSprites, TransformComponent()));
+  registry->Update();
+
+  // Each frame kills and spawns a few sprites, as projectiles do.
+  auto churn = [&]() {
+    for (size_t i = 0; i < spawnsPerFrame; i++) {
+      const size_t victim = random() % entities.size();
+      entities[victim].Kill();
+      entities[victim] = registry->CreateEntity();
+      entities[victim].AddComponent<SpriteLikeComponent>("bullet-image", 4);
+      entities[victim].AddComponent<TransformComponent>();
+    }
+    registry->Update();
+  };
+
+  float checksum = 0;
+  double copySortMillis = 0;
+  double sortedPoolMillis = 0;
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    churn();
+
+    auto start = std::chrono::steady_clock::now();
+    struct RenderableEntity {
+      TransformComponent transform;
+      SpriteLikeComponent sprite;
+    };
+    std::vector<RenderableEntity> renderables;
+    registry->View<SpriteLikeComponent, TransformComponent>().Each(
+        [&renderables](const SpriteLikeComponent& sprite,
+                       const TransformComponent& transform) {
+          renderables.push_back({transform, sprite});
+        });
+    std::sort(renderables.begin(), renderables.end(),
+              [](const RenderableEntity& a, const RenderableEntity& b) {
+                return IsDrawnBefore(a.sprite, b.sprite);
+              });
+    for (const auto& renderable : renderables) {
+      checksum += renderable.transform.position.x * renderable.sprite.width;
+    }
+    auto end = std::chrono::steady_clock::now();
+    copySortMillis +=
+        std::chrono::duration<double, std::milli>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    registry->SortComponents<SpriteLikeComponent>(IsDrawnBefore);
+    registry->View<SpriteLikeComponent, TransformComponent>().EachInOrder(
+        [&checksum](const SpriteLikeComponent& sprite,
+                    const TransformComponent& transform) {
+          checksum += transform.position.x * sprite.width;
+        });
+    end = std::chrono::steady_clock::now();
+    sortedPoolMillis +=
+        std::chrono::duration<double, std::milli>(end - start).count();
+  }
+
+  registry.reset();
+  std::cout.rdbuf(coutBuffer);
+  std::cout << numSprites << " sprites, " << spawnsPerFrame
+            << " spawns/frame: copy and sort " << copySortMillis / NUM_FRAMES
+            << " ms, sorted pool " << sortedPoolMillis / NUM_FRAMES
+            << " ms (checksum " << checksum << ")" << std::endl;
+}
+
+int main() {
+  RunBenchmark(1000, 10);
+  RunBenchmark(100000, 10);
+  RunBenchmark(100000, 0);
+  return 0;
+}
@@ -0,0 +1,111 @@
+// Measures Registry::Serialize and Deserialize on a world of plain
+// components plus one string-carrying type that goes through a
+// ComponentSerializer. Build with `make bench` and run
+// ./out/benchmarks/SnapshotBenchmark.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/Components/BoxColliderComponent.h"
+#include "../src/Components/RigidBodyComponent.h"
+#include "../src/Components/TransformComponent.h"
+#include "../src/ECS/ECS.h"
+
+// Stands in for SpriteComponent, which needs the SDL headers.
+struct NameComponent {
+  std::string name;
+
+  NameComponent(std::string name = "") : name(name) {}
+};
+
+template <>
+struct ComponentSerializer<NameComponent> {
+  static constexpr bool isSupported = true;
+
+  static void Write(BinaryWriter& writer, const NameComponent& component) {
+    writer.WriteString(component.name);
+  }
+
+  static void Read(BinaryReader& reader, NameComponent& component) {
+    reader.ReadString(component.name);
+  }
+};
+
+template <typename TFunction>
+double MeasureMillis(TFunction function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+float Checksum(Registry& registry) {
+  float checksum = 0;
+  registry.View<TransformComponent, RigidBodyComponent>().Each(
+      [&checksum](TransformComponent& transform, RigidBodyComponent& body) {
+        checksum += transform.position.x + body.velocity.y;
+      });
+  registry.View<NameComponent>().Each(
+      [&checksum](NameComponent& component) {
+        checksum += component.name.size();
+      });
+  return checksum;
+}
+
+void RunBenchmark(size_t numEntities, size_t namedEvery) {
+  // The registry logs every structural change; keep it off the console.
+  std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+  auto source = std::make_unique<Registry>();
+  std::vector<Entity> entities = source->CreateEntities(numEntities);
+  std::vector<TransformComponent> transforms;
+  std::vector<RigidBodyComponent> bodies;
+  for (size_t i = 0; i < numEntities; i++) {
+    transforms.emplace_back(glm::vec2(i, 0));
+    bodies.emplace_back(glm::vec2(0, i % 7));
+  }
+  source->AddComponents(entities, std::move(transforms));
+  source->AddComponents(entities, std::move(bodies));
+  source->AddComponents(
+      entities,
+      std::vector<BoxColliderComponent>(numEntities, BoxColliderComponent()));
+  for (size_t i = 0; i < numEntities; i += namedEvery) {
+    entities[i].AddComponent<NameComponent>("entity-" + std::to_string(i));
+  }
+  source->Update();
+
+  // The first round pays for fresh memory: the blob and the target's pools.
+  // The second reuses both, as repeated snapshots would.
+  std::vector<uint8_t> blob;
+  auto target = std::make_unique<Registry>();
+  bool isLoaded = false;
+  double serialize[2];
+  double deserialize[2];
+  for (int round = 0; round < 2; round++) {
+    serialize[round] = MeasureMillis([&]() { source->Serialize(blob); });
+    deserialize[round] =
+        MeasureMillis([&]() { isLoaded = target->Deserialize(blob); });
+  }
+  const bool isEqual = isLoaded && Checksum(*source) == Checksum(*target);
+
+  source.reset();
+  target.reset();
+  std::cout.rdbuf(coutBuffer);
+  std::cout << numEntities << " entities, 1 in " << namedEvery << " named, "
+            << blob.size() / 1024 << " KB" << (isEqual ? "" : " (MISMATCH)")
+            << std::endl
+            << "  cold: serialize " << serialize[0] << " ms, deserialize "
+            << deserialize[0] << " ms" << std::endl
+            << "  warm: serialize " << serialize[1] << " ms, deserialize "
+            << deserialize[1] << " ms" << std::endl;
+}
+
+int main() {
+  RunBenchmark(10000, 10);
+  RunBenchmark(100000, 10);
+  RunBenchmark(100000, 1);
+  return 0;
+}
@@ -0,0 +1,131 @@
+// Compares the dynamic Registry with StaticRegistry, whose component and
+// system types are fixed at compile time. Build with `make bench` and run
+// ./out/benchmarks/StaticRegistryBenchmark.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/Components/RigidBodyComponent.h"
+#include "../src/Components/TransformComponent.h"
+#include "../src/ECS/ECS.h"
+#include "../src/ECS/StaticRegistry.h"
+
+class CounterSystem : public System {
+ public:
+  int updates = 0;
+};
+
+class OtherSystem : public System {
+ public:
+  int updates = 0;
+};
+
+typedef StaticRegistry<TypeList<TransformComponent, RigidBodyComponent>,
+                       TypeList<CounterSystem, OtherSystem>>
+    BenchmarkStaticRegistry;
+
+template <typename TFunction>
+double MeasureMillis(TFunction function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+  const size_t numEntities = 100000;
+  const size_t numLookups = 1000000;
+  const size_t numFrames = 100;
+
+  std::mt19937 random(42);
+  std::uniform_int_distribution<size_t> pick(0, numEntities - 1);
+  std::vector<size_t> lookups(numLookups);
+  for (auto& lookup : lookups) {
+    lookup = pick(random);
+  }
+
+  std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+  auto registry = std::make_unique<Registry>();
+  registry->AddSystem<CounterSystem>();
+  registry->AddSystem<OtherSystem>();
+  std::vector<Entity> entities = registry->CreateEntities(numEntities);
+  registry->AddComponents(
+      entities, std::vector<TransformComponent>(numEntities,
+                                                TransformComponent()));
+  registry->AddComponents(
+      entities, std::vector<RigidBodyComponent>(
+                    numEntities, RigidBodyComponent(glm::vec2(1.0, 2.0))));
+  registry->Update();
+  std::cout.rdbuf(coutBuffer);
+
+  BenchmarkStaticRegistry staticRegistry;
+  std::vector<EntityHandle> handles;
+  for (size_t i = 0; i < numEntities; i++) {
+    handles.push_back(staticRegistry.CreateEntity());
+    staticRegistry.AddComponent<TransformComponent>(handles.back());
+    staticRegistry.AddComponent<RigidBodyComponent>(handles.back(),
+                                                    glm::vec2(1.0, 2.0));
+  }
+
+  float checksum = 0;
+  const double dynamicGet = MeasureMillis([&]() {
+    for (auto lookup : lookups) {
+      checksum += entities[lookup].GetComponent<TransformComponent>().scale.x;
+    }
+  });
+  const double staticGet = MeasureMillis([&]() {
+    for (auto lookup : lookups) {
+      checksum += staticRegistry.GetComponent<TransformComponent>(
+                                    handles[lookup])
+                      .scale.x;
+    }
+  });
+
+  const double dynamicSystem = MeasureMillis([&]() {
+    for (size_t i = 0; i < numLookups; i++) {
+      registry->GetSystem<CounterSystem>().updates++;
+      registry->GetSystem<OtherSystem>().updates++;
+    }
+  });
+  const double staticSystem = MeasureMillis([&]() {
+    for (size_t i = 0; i < numLookups; i++) {
+      staticRegistry.GetSystem<CounterSystem>().updates++;
+      staticRegistry.GetSystem<OtherSystem>().updates++;
+    }
+  });
+
+  auto integrate = [](TransformComponent& transform,
+                      const RigidBodyComponent& rigidbody) {
+    transform.position += rigidbody.velocity * 0.016f;
+  };
+  const double dynamicMove = MeasureMillis([&]() {
+    for (size_t frame = 0; frame < numFrames; frame++) {
+      registry->View<TransformComponent, RigidBodyComponent>().Each(integrate);
+    }
+  });
+  const double staticMove = MeasureMillis([&]() {
+    for (size_t frame = 0; frame < numFrames; frame++) {
+      staticRegistry.Each<TransformComponent, RigidBodyComponent>(integrate);
+    }
+  });
+
+  checksum += registry->GetSystem<CounterSystem>().updates +
+              staticRegistry.GetSystem<OtherSystem>().updates;
+  std::cout << numEntities << " entities, " << numLookups << " lookups, "
+            << numFrames << " frames (checksum " << checksum << ")"
+            << std::endl;
+  std::cout << "GetComponent: dynamic " << dynamicGet << " ms, static "
+            << staticGet << " ms" << std::endl;
+  std::cout << "GetSystem x2: dynamic " << dynamicSystem << " ms, static "
+            << staticSystem << " ms" << std::endl;
+  std::cout << "movement view: dynamic " << dynamicMove << " ms, static "
+            << staticMove << " ms" << std::endl;
+
+  coutBuffer = std::cout.rdbuf(nullptr);
+  registry.reset();
+  std::cout.rdbuf(coutBuffer);
+  return 0;
+}
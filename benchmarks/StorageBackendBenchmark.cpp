@@ -0,0 +1,129 @@
+// Compares the per-type pool backend of Registry with the archetype backend
+// on a movement/render shaped world. Build with `make bench` and run
+// ./out/benchmarks/StorageBackendBenchmark.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/Components/BoxColliderComponent.h"
+#include "../src/Components/RigidBodyComponent.h"
+#include "../src/Components/TransformComponent.h"
+#include "../src/ECS/ECS.h"
+
+template <typename TFunction>
+double MeasureMillis(TFunction function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void RunBenchmark(const std::string& name, StorageBackend storageBackend,
+                  size_t numEntities, size_t numFrames) {
+  // The registry logs every structural change; keep it off the console.
+  std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+  auto registryPtr = std::make_unique<Registry>(storageBackend);
+  Registry& registry = *registryPtr;
+  std::vector<Entity> entities;
+  const double create = MeasureMillis([&]() {
+    for (size_t i = 0; i < numEntities; i++) {
+      Entity entity = registry.CreateEntity();
+      entity.AddComponent<TransformComponent>(glm::vec2(i, i));
+      entity.AddComponent<RigidBodyComponent>(glm::vec2(1.0, 2.0));
+      if (i % 2 == 0) {
+        entity.AddComponent<BoxColliderComponent>(4, 4);
+      }
+      entities.push_back(entity);
+    }
+    registry.Update();
+  });
+
+  const double move = MeasureMillis([&]() {
+    for (size_t frame = 0; frame < numFrames; frame++) {
+      registry.View<TransformComponent, RigidBodyComponent>().Each(
+          [](TransformComponent& transform,
+             const RigidBodyComponent& rigidbody) {
+            transform.position += rigidbody.velocity * 0.016f;
+          });
+    }
+  });
+
+  float checksum = 0;
+  const double collide = MeasureMillis([&]() {
+    for (size_t frame = 0; frame < numFrames; frame++) {
+      registry.View<TransformComponent, BoxColliderComponent>().Each(
+          [&checksum](const TransformComponent& transform,
+                      const BoxColliderComponent& collider) {
+            checksum += transform.position.x + collider.width;
+          });
+    }
+  });
+
+  std::mt19937 random(42);
+  std::uniform_int_distribution<size_t> pick(0, numEntities - 1);
+  const double get = MeasureMillis([&]() {
+    for (size_t i = 0; i < numEntities; i++) {
+      checksum +=
+          entities[pick(random)].GetComponent<TransformComponent>().position.y;
+    }
+  });
+
+  const double kill = MeasureMillis([&]() {
+    for (size_t i = 0; i < numEntities; i += 2) {
+      entities[i].Kill();
+    }
+    registry.Update();
+  });
+
+  registryPtr.reset();
+  std::cout.rdbuf(coutBuffer);
+  std::cout << name << ": create " << create << " ms, move " << move
+            << " ms, transform+collider " << collide << " ms, random get "
+            << get << " ms, kill half " << kill << " ms (checksum "
+            << checksum << ")" << std::endl;
+}
+
+void RunBulkCreateBenchmark(const std::string& name,
+                            StorageBackend storageBackend,
+                            size_t numEntities) {
+  std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+  auto registry = std::make_unique<Registry>(storageBackend);
+
+  const double bulkCreate = MeasureMillis([&]() {
+    std::vector<Entity> entities = registry->CreateEntities(numEntities);
+    std::vector<TransformComponent> transforms;
+    std::vector<RigidBodyComponent> rigidbodies;
+    transforms.reserve(numEntities);
+    rigidbodies.reserve(numEntities);
+    for (size_t i = 0; i < numEntities; i++) {
+      transforms.emplace_back(glm::vec2(i, i));
+      rigidbodies.emplace_back(glm::vec2(1.0, 2.0));
+    }
+    registry->AddComponents(entities, std::move(transforms));
+    registry->AddComponents(entities, std::move(rigidbodies));
+    registry->Update();
+  });
+
+  registry.reset();
+  std::cout.rdbuf(coutBuffer);
+  std::cout << name << ": bulk create " << bulkCreate << " ms" << std::endl;
+}
+
+int main() {
+  const size_t numEntities = 100000;
+  const size_t numFrames = 100;
+  std::cout << numEntities << " entities, " << numFrames << " frames"
+            << std::endl;
+  RunBenchmark("pools", StorageBackend::Pools, numEntities, numFrames);
+  RunBenchmark("archetypes", StorageBackend::Archetypes, numEntities,
+               numFrames);
+  RunBulkCreateBenchmark("pools", StorageBackend::Pools, numEntities);
+  RunBulkCreateBenchmark("archetypes", StorageBackend::Archetypes,
+                         numEntities);
+  return 0;
+}
@@ -2,6 +2,8 @@
 
 #include <SDL2/SDL.h>
 
+#include "../ECS/Serialization.h"
+
 struct AnimationComponent {
   int numFrames;
   int currentFrame;
@@ -17,3 +19,25 @@ struct AnimationComponent {
         shouldLoop(shouldLoop),
         startTime(SDL_GetTicks()) {}
 };
+
+template <>
+struct ComponentSerializer<AnimationComponent> {
+  static constexpr bool isSupported = true;
+
+  static void Write(BinaryWriter& writer,
+                    const AnimationComponent& animation) {
+    writer.Write(animation.numFrames);
+    writer.Write(animation.currentFrame);
+    writer.Write(animation.frameRateSpeed);
+    writer.WriteBool(animation.shouldLoop);
+    writer.Write(animation.startTime);
+  }
+
+  static void Read(BinaryReader& reader, AnimationComponent& animation) {
+    reader.Read(animation.numFrames);
+    reader.Read(animation.currentFrame);
+    reader.Read(animation.frameRateSpeed);
+    reader.ReadBool(animation.shouldLoop);
+    reader.Read(animation.startTime);
+  }
+};
@@ -2,6 +2,8 @@
 
 #include <SDL2/SDL.h>
 
+#include "../ECS/Serialization.h"
+
 struct ProjectileComponent {
   int hitPercentDamage;
   int duration;
@@ -16,3 +18,23 @@ struct ProjectileComponent {
     startTime = SDL_GetTicks();
   }
 };
+
+template <>
+struct ComponentSerializer<ProjectileComponent> {
+  static constexpr bool isSupported = true;
+
+  static void Write(BinaryWriter& writer,
+                    const ProjectileComponent& projectile) {
+    writer.Write(projectile.hitPercentDamage);
+    writer.Write(projectile.duration);
+    writer.WriteBool(projectile.isFriendly);
+    writer.Write(projectile.startTime);
+  }
+
+  static void Read(BinaryReader& reader, ProjectileComponent& projectile) {
+    reader.Read(projectile.hitPercentDamage);
+    reader.Read(projectile.duration);
+    reader.ReadBool(projectile.isFriendly);
+    reader.Read(projectile.startTime);
+  }
+};
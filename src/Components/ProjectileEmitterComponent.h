@@ -4,6 +4,8 @@
 
 #include <glm/glm.hpp>
 
+#include "../ECS/Serialization.h"
+
 struct ProjectileEmitterComponent {
   glm::vec2 projectileVelocity;
   int repeatFrequency;
@@ -24,3 +26,28 @@ struct ProjectileEmitterComponent {
     lastEmissionTime = SDL_GetTicks();
   }
 };
+
+template <>
+struct ComponentSerializer<ProjectileEmitterComponent> {
+  static constexpr bool isSupported = true;
+
+  static void Write(BinaryWriter& writer,
+                    const ProjectileEmitterComponent& emitter) {
+    writer.Write(emitter.projectileVelocity);
+    writer.Write(emitter.repeatFrequency);
+    writer.Write(emitter.projectileDuration);
+    writer.Write(emitter.hitPercentDamage);
+    writer.WriteBool(emitter.isFriendly);
+    writer.Write(emitter.lastEmissionTime);
+  }
+
+  static void Read(BinaryReader& reader,
+                   ProjectileEmitterComponent& emitter) {
+    reader.Read(emitter.projectileVelocity);
+    reader.Read(emitter.repeatFrequency);
+    reader.Read(emitter.projectileDuration);
+    reader.Read(emitter.hitPercentDamage);
+    reader.ReadBool(emitter.isFriendly);
+    reader.Read(emitter.lastEmissionTime);
+  }
+};
@@ -5,6 +5,8 @@
 #include <glm/glm.hpp>
 #include <string>
 
+#include "../ECS/Serialization.h"
+
 struct SpriteComponent {
   std::string assetId;
   size_t zIndex;
@@ -24,3 +26,28 @@ struct SpriteComponent {
     srcRect = {srcRectX, srcRectY, width, height};
   }
 };
+
+template <>
+struct ComponentSerializer<SpriteComponent> {
+  static constexpr bool isSupported = true;
+
+  static void Write(BinaryWriter& writer, const SpriteComponent& sprite) {
+    writer.WriteString(sprite.assetId);
+    writer.Write(static_cast<uint64_t>(sprite.zIndex));
+    writer.Write(sprite.width);
+    writer.Write(sprite.height);
+    writer.WriteBool(sprite.isFixed);
+    writer.Write(sprite.srcRect);
+  }
+
+  static void Read(BinaryReader& reader, SpriteComponent& sprite) {
+    uint64_t zIndex = 0;
+    reader.ReadString(sprite.assetId);
+    reader.Read(zIndex);
+    reader.Read(sprite.width);
+    reader.Read(sprite.height);
+    reader.ReadBool(sprite.isFixed);
+    reader.Read(sprite.srcRect);
+    sprite.zIndex = static_cast<size_t>(zIndex);
+  }
+};
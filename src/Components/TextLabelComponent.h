@@ -5,6 +5,8 @@
 #include <glm/glm.hpp>
 #include <string>
 
+#include "../ECS/Serialization.h"
+
 struct TextLabelComponent {
   glm::vec2 position;
   std::string text;
@@ -21,3 +23,24 @@ struct TextLabelComponent {
         color(color),
         isFixed(isFixed) {}
 };
+
+template <>
+struct ComponentSerializer<TextLabelComponent> {
+  static constexpr bool isSupported = true;
+
+  static void Write(BinaryWriter& writer, const TextLabelComponent& label) {
+    writer.Write(label.position);
+    writer.WriteString(label.text);
+    writer.WriteString(label.assetId);
+    writer.Write(label.color);
+    writer.WriteBool(label.isFixed);
+  }
+
+  static void Read(BinaryReader& reader, TextLabelComponent& label) {
+    reader.Read(label.position);
+    reader.ReadString(label.text);
+    reader.ReadString(label.assetId);
+    reader.Read(label.color);
+    reader.ReadBool(label.isFixed);
+  }
+};
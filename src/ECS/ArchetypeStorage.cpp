@@ -0,0 +1,170 @@
+#include "ArchetypeStorage.h"
+
+namespace {
+size_t AlignUp(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+Archetype::Archetype(const Signature& signature,
+                     const std::vector<ComponentInfo>& allComponentInfos)
+    : signature(signature) {
+  size_t rowSize = sizeof(size_t);
+  for (size_t componentId = 0; componentId < MAX_COMPONENTS; componentId++) {
+    if (signature.test(componentId)) {
+      componentIds.push_back(componentId);
+      componentInfos.push_back(allComponentInfos[componentId]);
+      componentSizes[componentId] = allComponentInfos[componentId].size;
+      rowSize += allComponentInfos[componentId].size;
+    }
+  }
+
+  // Shrink the capacity until the aligned columns fit in one chunk. A single
+  // row is assumed to fit, which holds for every component in the game.
+  chunkCapacity = CHUNK_SIZE / rowSize;
+  for (;;) {
+    size_t offset = chunkCapacity * sizeof(size_t);
+    for (size_t i = 0; i < componentIds.size(); i++) {
+      offset = AlignUp(offset, componentInfos[i].alignment);
+      columnOffsets[componentIds[i]] = offset;
+      offset += chunkCapacity * componentInfos[i].size;
+    }
+    if (offset <= CHUNK_SIZE || chunkCapacity == 1) {
+      break;
+    }
+    chunkCapacity--;
+  }
+}
+
+size_t Archetype::AllocateRow(size_t entityId) {
+  if (size == chunks.size() * chunkCapacity) {
+    chunks.push_back(std::make_unique<Chunk>());
+  }
+  const size_t row = size++;
+  reinterpret_cast<size_t*>(
+      chunks[row / chunkCapacity]->bytes)[row % chunkCapacity] = entityId;
+  return row;
+}
+
+size_t Archetype::RemoveRow(size_t row) {
+  const size_t chunk = row / chunkCapacity;
+  const size_t chunkRow = row % chunkCapacity;
+  const size_t last = size - 1;
+  const size_t lastChunk = last / chunkCapacity;
+  const size_t lastChunkRow = last % chunkCapacity;
+
+  for (size_t i = 0; i < componentIds.size(); i++) {
+    componentInfos[i].destroy(GetComponent(chunk, chunkRow, componentIds[i]));
+  }
+
+  size_t* entityIds = reinterpret_cast<size_t*>(chunks[chunk]->bytes);
+  const size_t* lastEntityIds =
+      reinterpret_cast<const size_t*>(chunks[lastChunk]->bytes);
+  const size_t movedEntityId = lastEntityIds[lastChunkRow];
+  if (row != last) {
+    for (size_t i = 0; i < componentIds.size(); i++) {
+      void* lastComponent =
+          GetComponent(lastChunk, lastChunkRow, componentIds[i]);
+      componentInfos[i].moveConstruct(
+          GetComponent(chunk, chunkRow, componentIds[i]), lastComponent);
+      componentInfos[i].destroy(lastComponent);
+    }
+    entityIds[chunkRow] = movedEntityId;
+  }
+
+  size--;
+  if (size == (chunks.size() - 1) * chunkCapacity) {
+    chunks.pop_back();
+  }
+  return movedEntityId;
+}
+
+ArchetypeStorage::~ArchetypeStorage() {
+  for (auto& archetype : archetypes) {
+    while (archetype->GetSize() > 0) {
+      archetype->RemoveRow(archetype->GetSize() - 1);
+    }
+  }
+}
+
+void ArchetypeStorage::Remove(size_t entityId, size_t componentId) {
+  Archetype* source = locations[entityId].archetype;
+  if (!source || !source->GetSignature().test(componentId)) {
+    return;
+  }
+  MoveEntity(entityId, GetTargetArchetype(source, componentId, false));
+}
+
+void ArchetypeStorage::RemoveEntity(size_t entityId) {
+  if (entityId < locations.size() && locations[entityId].archetype) {
+    MoveEntity(entityId, nullptr);
+  }
+}
+
+Archetype* ArchetypeStorage::GetOrCreateArchetype(const Signature& signature) {
+  auto archetype = archetypesBySignature.find(signature);
+  if (archetype != archetypesBySignature.end()) {
+    return archetype->second;
+  }
+  archetypes.push_back(std::make_unique<Archetype>(signature, componentInfos));
+  archetypesBySignature.emplace(signature, archetypes.back().get());
+  return archetypes.back().get();
+}
+
+Archetype* ArchetypeStorage::GetTargetArchetype(Archetype* source,
+                                                size_t componentId,
+                                                bool isAdding) {
+  if (!source) {
+    Signature signature;
+    signature.set(componentId);
+    return GetOrCreateArchetype(signature);
+  }
+
+  auto& edge = isAdding ? source->addEdges[componentId]
+                        : source->removeEdges[componentId];
+  if (!edge) {
+    Signature signature = source->GetSignature();
+    signature.set(componentId, isAdding);
+    edge = signature.none() ? nullptr : GetOrCreateArchetype(signature);
+  }
+  return edge;
+}
+
+void ArchetypeStorage::MoveEntity(size_t entityId, Archetype* target) {
+  EntityLocation& location = locations[entityId];
+  Archetype* source = location.archetype;
+
+  EntityLocation newLocation;
+  if (target) {
+    const size_t row = target->AllocateRow(entityId);
+    newLocation.archetype = target;
+    newLocation.chunk = row / target->GetChunkCapacity();
+    newLocation.row = row % target->GetChunkCapacity();
+
+    if (source) {
+      const Signature shared = source->GetSignature() & target->GetSignature();
+      for (size_t componentId = 0; componentId < MAX_COMPONENTS;
+           componentId++) {
+        if (shared.test(componentId)) {
+          componentInfos[componentId].moveConstruct(
+              target->GetComponent(newLocation.chunk, newLocation.row,
+                                   componentId),
+              source->GetComponent(location.chunk, location.row,
+                                   componentId));
+        }
+      }
+    }
+  }
+
+  if (source) {
+    const size_t row =
+        location.chunk * source->GetChunkCapacity() + location.row;
+    const size_t movedEntityId = source->RemoveRow(row);
+    if (movedEntityId != entityId) {
+      locations[movedEntityId].chunk = location.chunk;
+      locations[movedEntityId].row = location.row;
+    }
+  }
+
+  locations[entityId] = newLocation;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Signature.h"
+
+// Type-erased description of a component type, enough to move and destroy
+// instances living in raw chunk memory.
+struct ComponentInfo {
+  size_t size = 0;
+  size_t alignment = 0;
+  void (*moveConstruct)(void* destination, void* source) = nullptr;
+  void (*destroy)(void* component) = nullptr;
+
+  template <typename T>
+  static ComponentInfo Of() {
+    ComponentInfo info;
+    info.size = sizeof(T);
+    info.alignment = alignof(T);
+    info.moveConstruct = [](void* destination, void* source) {
+      new (destination) T(std::move(*static_cast<T*>(source)));
+    };
+    info.destroy = [](void* component) { static_cast<T*>(component)->~T(); };
+    return info;
+  }
+};
+
+// All entities sharing one Signature. Rows are packed into fixed-size chunks
+// holding one contiguous array per component type plus the entity ids.
+class Archetype {
+ public:
+  static constexpr size_t CHUNK_SIZE = 16 * 1024;
+  static constexpr size_t CHUNK_ALIGNMENT = 64;
+
+  Archetype(const Signature& signature,
+            const std::vector<ComponentInfo>& componentInfos);
+
+  const Signature& GetSignature() const { return signature; }
+
+  size_t GetSize() const { return size; }
+
+  size_t GetChunkCapacity() const { return chunkCapacity; }
+
+  size_t GetChunkCount() const { return chunks.size(); }
+
+  size_t GetChunkSize(size_t chunk) const {
+    return chunk + 1 < chunks.size() ? chunkCapacity
+                                     : size - chunk * chunkCapacity;
+  }
+
+  const size_t* GetEntityIds(size_t chunk) const {
+    return reinterpret_cast<const size_t*>(chunks[chunk]->bytes);
+  }
+
+  template <typename T>
+  T* GetColumn(size_t chunk, size_t componentId) {
+    return reinterpret_cast<T*>(chunks[chunk]->bytes +
+                                columnOffsets[componentId]);
+  }
+
+  void* GetComponent(size_t chunk, size_t row, size_t componentId) {
+    return chunks[chunk]->bytes + columnOffsets[componentId] +
+           row * componentSizes[componentId];
+  }
+
+  // Appends an uninitialized row for the entity and returns its index.
+  size_t AllocateRow(size_t entityId);
+
+  // Destroys the row's components and fills the hole with the last row.
+  // Returns the id of the entity that moved into the hole, or the removed
+  // entity itself when it was the last row.
+  size_t RemoveRow(size_t row);
+
+  // Cached transitions to the archetype with one component added/removed.
+  std::array<Archetype*, MAX_COMPONENTS> addEdges{};
+  std::array<Archetype*, MAX_COMPONENTS> removeEdges{};
+
+ private:
+  struct alignas(CHUNK_ALIGNMENT) Chunk {
+    unsigned char bytes[CHUNK_SIZE];
+  };
+
+ private:
+  Signature signature;
+  std::vector<size_t> componentIds;
+  std::vector<ComponentInfo> componentInfos;
+  std::array<size_t, MAX_COMPONENTS> columnOffsets{};
+  std::array<size_t, MAX_COMPONENTS> componentSizes{};
+  size_t chunkCapacity;
+  size_t size = 0;
+  std::vector<std::unique_ptr<Chunk>> chunks;
+};
+
+// Archetype based component storage used by Registry when it is created with
+// StorageBackend::Archetypes. Component ids are supplied by the caller.
+class ArchetypeStorage {
+ public:
+  ArchetypeStorage() = default;
+  ~ArchetypeStorage();
+
+  template <typename T>
+  void Set(size_t entityId, size_t componentId, T component);
+
+  void Remove(size_t entityId, size_t componentId);
+
+  void RemoveEntity(size_t entityId);
+
+  template <typename T>
+  T& Get(size_t entityId, size_t componentId) {
+    const auto& location = locations[entityId];
+    return *static_cast<T*>(
+        location.archetype->GetComponent(location.chunk, location.row,
+                                         componentId));
+  }
+
+  size_t GetArchetypeCount() const { return archetypes.size(); }
+
+  // Calls function(entityId, TComponents&...) for every row of every
+  // archetype matching the signatures. The callback must not change the
+  // components of the entities being iterated.
+  template <typename... TComponents, typename TFunction>
+  void Each(const Signature& requiredSignature,
+            const Signature& excludedSignature,
+            const std::array<size_t, sizeof...(TComponents)>& componentIds,
+            TFunction function);
+
+ private:
+  struct EntityLocation {
+    Archetype* archetype = nullptr;
+    uint32_t chunk = 0;
+    uint32_t row = 0;
+  };
+
+  Archetype* GetOrCreateArchetype(const Signature& signature);
+  Archetype* GetTargetArchetype(Archetype* source, size_t componentId,
+                                bool isAdding);
+
+  // Moves the entity's row into the target archetype (nullptr for no
+  // components). Components the target has but the source lacks are left
+  // uninitialized for the caller to construct.
+  void MoveEntity(size_t entityId, Archetype* target);
+
+  template <typename... TComponents, typename TFunction, size_t... Indices>
+  void EachInArchetype(Archetype& archetype,
+                       const std::array<size_t, sizeof...(TComponents)>& ids,
+                       TFunction& function, std::index_sequence<Indices...>);
+
+ private:
+  std::vector<ComponentInfo> componentInfos;
+  std::vector<EntityLocation> locations;
+  std::vector<std::unique_ptr<Archetype>> archetypes;
+  std::unordered_map<Signature, Archetype*> archetypesBySignature;
+};
+
+template <typename T>
+void ArchetypeStorage::Set(size_t entityId, size_t componentId, T component) {
+  if (componentId >= componentInfos.size()) {
+    componentInfos.resize(componentId + 1);
+  }
+  if (!componentInfos[componentId].destroy) {
+    componentInfos[componentId] = ComponentInfo::Of<T>();
+  }
+  if (entityId >= locations.size()) {
+    locations.resize(entityId + 1);
+  }
+
+  Archetype* source = locations[entityId].archetype;
+  if (source && source->GetSignature().test(componentId)) {
+    Get<T>(entityId, componentId) = std::move(component);
+    return;
+  }
+
+  MoveEntity(entityId, GetTargetArchetype(source, componentId, true));
+  new (&Get<T>(entityId, componentId)) T(std::move(component));
+}
+
+template <typename... TComponents, typename TFunction>
+void ArchetypeStorage::Each(
+    const Signature& requiredSignature, const Signature& excludedSignature,
+    const std::array<size_t, sizeof...(TComponents)>& componentIds,
+    TFunction function) {
+  // Callbacks may create archetypes, so walk by index.
+  for (size_t i = 0; i < archetypes.size(); i++) {
+    Archetype& archetype = *archetypes[i];
+    const Signature& signature = archetype.GetSignature();
+    if ((signature & requiredSignature) != requiredSignature ||
+        (signature & excludedSignature).any()) {
+      continue;
+    }
+    EachInArchetype<TComponents...>(archetype, componentIds, function,
+                                    std::index_sequence_for<TComponents...>());
+  }
+}
+
+template <typename... TComponents, typename TFunction, size_t... Indices>
+void ArchetypeStorage::EachInArchetype(
+    Archetype& archetype, const std::array<size_t, sizeof...(TComponents)>& ids,
+    TFunction& function, std::index_sequence<Indices...>) {
+  for (size_t chunk = 0; chunk < archetype.GetChunkCount(); chunk++) {
+    const size_t* entityIds = archetype.GetEntityIds(chunk);
+    const std::tuple<TComponents*...> columns(
+        archetype.GetColumn<TComponents>(chunk, ids[Indices])...);
+    const size_t count = archetype.GetChunkSize(chunk);
+    for (size_t row = 0; row < count; row++) {
+      function(entityIds[row], std::get<Indices>(columns)[row]...);
+    }
+  }
+}
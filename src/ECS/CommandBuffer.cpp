@@ -0,0 +1,81 @@
+#include "CommandBuffer.h"
+
+PendingEntity CommandBuffer::CreateEntity() {
+  const PendingEntity entity{numPendingEntities++};
+  commands.push_back({CommandType::CreateEntity, entity});
+  return entity;
+}
+
+void CommandBuffer::KillEntity(CommandTarget target) {
+  commands.push_back({CommandType::KillEntity, target});
+}
+
+void CommandBuffer::Tag(CommandTarget target, TagId tag) {
+  Command command{CommandType::Tag, target};
+  command.id = tag;
+  commands.push_back(command);
+}
+
+void CommandBuffer::Group(CommandTarget target, GroupId group) {
+  Command command{CommandType::Group, target};
+  command.id = group;
+  commands.push_back(command);
+}
+
+void CommandBuffer::Apply(Registry& registry) {
+  createdEntities.clear();
+  for (auto& command : commands) {
+    if (command.type == CommandType::CreateEntity) {
+      createdEntities.push_back(registry.CreateEntity());
+      continue;
+    }
+    if (command.type == CommandType::Instantiate) {
+      createdEntities.push_back(
+          command.instantiate(registry, command.id, command.payload));
+      continue;
+    }
+
+    const CommandTarget& target = command.target;
+    Entity entity = target.pendingIndex == CommandTarget::NOT_PENDING
+                        ? registry.GetEntity(target.handle)
+                        : createdEntities[target.pendingIndex];
+    // The entity may have died since the command was recorded.
+    if (!entity.IsAlive()) {
+      continue;
+    }
+    switch (command.type) {
+      case CommandType::KillEntity:
+        registry.KillEntity(entity);
+        break;
+      case CommandType::AddComponent:
+        command.apply(registry, entity, command.payload);
+        break;
+      case CommandType::RemoveComponent:
+        // Another command or buffer may have removed it already.
+        if (registry.HasComponent(entity, command.id)) {
+          command.apply(registry, entity, command.payload);
+        }
+        break;
+      case CommandType::Tag:
+        registry.TagEntity(entity, command.id);
+        break;
+      case CommandType::Group:
+        registry.GroupEntity(entity, command.id);
+        break;
+      default:
+        break;
+    }
+  }
+  Clear();
+}
+
+void CommandBuffer::Clear() {
+  for (auto& command : commands) {
+    if (command.destroy) {
+      command.destroy(command.payload);
+    }
+  }
+  commands.clear();
+  payloads.Reset();
+  numPendingEntities = 0;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ECS.h"
+#include "PoolArena.h"
+
+// Entity created by a CommandBuffer; it only becomes a real entity when the
+// buffer is applied.
+struct PendingEntity {
+  uint32_t index;
+};
+
+// Either an existing entity or one created earlier in the same buffer.
+class CommandTarget {
+ public:
+  CommandTarget(Entity entity)
+      : handle(entity.GetHandle()), pendingIndex(NOT_PENDING) {}
+  CommandTarget(PendingEntity entity) : pendingIndex(entity.index) {}
+
+ private:
+  friend class CommandBuffer;
+  static constexpr uint32_t NOT_PENDING = UINT32_MAX;
+
+  EntityHandle handle;
+  uint32_t pendingIndex;
+};
+
+// Records structural changes so systems running on scheduler threads can
+// request them without touching the Registry. Each buffer must be used by
+// one thread at a time; Registry::Update applies all buffers in the order
+// they were created, so the outcome does not depend on thread timing.
+// Commands live in a flat vector and component payloads in an arena that is
+// rewound, not freed, after every apply.
+class CommandBuffer {
+ public:
+  CommandBuffer() = default;
+  ~CommandBuffer() { Clear(); }
+
+  CommandBuffer(const CommandBuffer&) = delete;
+  CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+  bool IsEmpty() const { return commands.empty(); }
+
+  PendingEntity CreateEntity();
+  // Same as Registry::Instantiate; the overrides are stored in the buffer.
+  template <typename... TOverrides>
+  PendingEntity Instantiate(PrefabId prefab, TOverrides&&... overrides);
+  void KillEntity(CommandTarget target);
+
+  template <typename TComponent, typename... TArgs>
+  void AddComponent(CommandTarget target, TArgs&&... args);
+  template <typename TComponent>
+  void RemoveComponent(CommandTarget target);
+
+  void Tag(CommandTarget target, TagId tag);
+  void Group(CommandTarget target, GroupId group);
+
+  // Replays the recorded commands in order and clears the buffer.
+  void Apply(Registry& registry);
+
+ private:
+  enum class CommandType {
+    CreateEntity,
+    Instantiate,
+    KillEntity,
+    AddComponent,
+    RemoveComponent,
+    Tag,
+    Group
+  };
+
+  struct Command {
+    CommandType type;
+    CommandTarget target;
+    // Component commands: type-erased operation on the payload.
+    void (*apply)(Registry& registry, Entity entity, void* payload) = nullptr;
+    // Instantiate commands: the payload holds the overrides.
+    Entity (*instantiate)(Registry& registry, PrefabId prefab,
+                          void* payload) = nullptr;
+    void (*destroy)(void* payload) = nullptr;
+    void* payload = nullptr;
+    // Tag, group and instantiate commands; the component id of remove
+    // commands.
+    uint32_t id = INVALID_NAME_ID;
+  };
+
+  void Clear();
+
+ private:
+  std::vector<Command> commands;
+  std::vector<Entity> createdEntities;
+  PoolArena payloads;
+  uint32_t numPendingEntities = 0;
+};
+
+template <typename... TOverrides>
+PendingEntity CommandBuffer::Instantiate(PrefabId prefab,
+                                         TOverrides&&... overrides) {
+  typedef std::tuple<std::decay_t<TOverrides>...> Overrides;
+  const PendingEntity entity{numPendingEntities++};
+  Command command{CommandType::Instantiate, entity};
+  command.id = prefab;
+  command.payload = payloads.Allocate(sizeof(Overrides), alignof(Overrides));
+  new (command.payload) Overrides(std::forward<TOverrides>(overrides)...);
+  command.instantiate = [](Registry& registry, PrefabId prefab,
+                           void* payload) {
+    return std::apply(
+        [&registry, prefab](auto&... overrides) {
+          return registry.Instantiate(prefab, std::move(overrides)...);
+        },
+        *static_cast<Overrides*>(payload));
+  };
+  command.destroy = [](void* payload) {
+    static_cast<Overrides*>(payload)->~Overrides();
+  };
+  commands.push_back(std::move(command));
+  return entity;
+}
+
+template <typename TComponent, typename... TArgs>
+void CommandBuffer::AddComponent(CommandTarget target, TArgs&&... args) {
+  Command command{CommandType::AddComponent, target};
+  command.payload = payloads.Allocate(sizeof(TComponent), alignof(TComponent));
+  new (command.payload) TComponent(std::forward<TArgs>(args)...);
+  command.apply = [](Registry& registry, Entity entity, void* payload) {
+    registry.AddComponent<TComponent>(
+        entity, std::move(*static_cast<TComponent*>(payload)));
+  };
+  command.destroy = [](void* payload) {
+    static_cast<TComponent*>(payload)->~TComponent();
+  };
+  commands.push_back(std::move(command));
+}
+
+template <typename TComponent>
+void CommandBuffer::RemoveComponent(CommandTarget target) {
+  Command command{CommandType::RemoveComponent, target};
+  command.id = static_cast<uint32_t>(Component<TComponent>::GetId());
+  command.apply = [](Registry& registry, Entity entity, void*) {
+    registry.RemoveComponent<TComponent>(entity);
+  };
+  commands.push_back(std::move(command));
+}
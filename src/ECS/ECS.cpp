@@ -1,169 +1,1022 @@
 #include "ECS.h"
 
-#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <mutex>
 
 #include "../Logger/Logger.h"
+#include "CommandBuffer.h"
 
-size_t IComponent::nextId = 0;
+namespace {
+std::mutex typesMutex;
+}  // namespace
 
-size_t Entity::GetId() const { return id; }
+std::vector<IComponent::TypeInfo>& IComponent::GetTypes() {
+  static std::vector<TypeInfo> types;
+  return types;
+}
+
+size_t IComponent::Register(const char* typeName,
+                            CreatePoolFunction createPool) {
+  std::lock_guard<std::mutex> lock(typesMutex);
+  auto& types = GetTypes();
+  types.push_back({typeName, createPool});
+  return types.size() - 1;
+}
+
+const std::string& IComponent::GetTypeName(size_t componentId) {
+  std::lock_guard<std::mutex> lock(typesMutex);
+  return GetTypes()[componentId].name;
+}
+
+size_t IComponent::FindId(const std::string& typeName) {
+  std::lock_guard<std::mutex> lock(typesMutex);
+  const auto& types = GetTypes();
+  for (size_t id = 0; id < types.size(); id++) {
+    if (types[id].name == typeName) {
+      return id;
+    }
+  }
+  return MAX_COMPONENTS;
+}
+
+bool IComponent::IsEmpty(size_t componentId) {
+  std::lock_guard<std::mutex> lock(typesMutex);
+  return GetTypes()[componentId].createPool == nullptr;
+}
+
+std::shared_ptr<IPool> IComponent::CreatePool(size_t componentId,
+                                              PoolArena* arena) {
+  CreatePoolFunction createPool = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(typesMutex);
+    createPool = GetTypes()[componentId].createPool;
+  }
+  return createPool ? createPool(arena) : nullptr;
+}
+
+size_t Entity::GetId() const { return handle.GetIndex(); }
+
+EntityHandle Entity::GetHandle() const { return handle; }
+
+bool Entity::IsAlive() const { return registry->IsAlive(handle); }
 
 void Entity::Kill() { registry->KillEntity(*this); }
 
-void Entity::Tag(const std::string tag) { registry->TagEntity(*this, tag); }
+namespace {
+// A deque keeps the names in place, so references handed out stay valid
+// while other threads intern new ones.
+struct NameTable {
+  std::unordered_map<std::string, uint32_t> ids;
+  std::deque<std::string> names;
+};
+
+std::mutex namesMutex;
+
+NameTable& GetTagNames() {
+  static NameTable tags;
+  return tags;
+}
+
+NameTable& GetGroupNames() {
+  static NameTable groups;
+  return groups;
+}
+
+uint32_t InternName(NameTable& table, const std::string& name) {
+  std::lock_guard<std::mutex> lock(namesMutex);
+  auto inserted =
+      table.ids.emplace(name, static_cast<uint32_t>(table.names.size()));
+  if (inserted.second) {
+    table.names.push_back(name);
+  }
+  return inserted.first->second;
+}
+
+const std::string& GetName(const NameTable& table, uint32_t id) {
+  static const std::string unknown;
+  std::lock_guard<std::mutex> lock(namesMutex);
+  return id < table.names.size() ? table.names[id] : unknown;
+}
+}  // namespace
+
+TagId GetTagId(const std::string& tag) {
+  return InternName(GetTagNames(), tag);
+}
+
+GroupId GetGroupId(const std::string& group) {
+  return InternName(GetGroupNames(), group);
+}
+
+const std::string& GetTagName(TagId tag) { return GetName(GetTagNames(), tag); }
+
+const std::string& GetGroupName(GroupId group) {
+  return GetName(GetGroupNames(), group);
+}
+
+void Entity::Tag(TagId tag) { registry->TagEntity(*this, tag); }
+
+void Entity::Tag(const std::string& tag) { Tag(GetTagId(tag)); }
 
-bool Entity::HasTag(const std::string tag) const {
+bool Entity::HasTag(TagId tag) const {
   return registry->EntityHasTag(*this, tag);
 }
 
-void Entity::Group(const std::string group) {
-  registry->GroupEntity(*this, group);
+bool Entity::HasTag(const std::string& tag) const {
+  return HasTag(GetTagId(tag));
 }
 
-bool Entity::BelongsToGroup(const std::string group) const {
+void Entity::Group(GroupId group) { registry->GroupEntity(*this, group); }
+
+void Entity::Group(const std::string& group) { Group(GetGroupId(group)); }
+
+bool Entity::BelongsToGroup(GroupId group) const {
   return registry->EntityBelongsToGroup(*this, group);
 }
 
-void System::AddEntityToSystem(Entity entity) { entities.push_back(entity); }
+bool Entity::BelongsToGroup(const std::string& group) const {
+  return BelongsToGroup(GetGroupId(group));
+}
+
+void System::AddEntityToSystem(Entity entity) {
+  if (!entityIndices.Contains(entity.GetId())) {
+    entityIndices.Insert(entity.GetId());
+    entities.push_back(entity.GetHandle());
+  }
+}
 
 void System::RemoveEntityFromSystem(Entity entity) {
-  entities.erase(
-      std::remove_if(entities.begin(), entities.end(),
-                     [&entity](Entity other) { return entity == other; }),
-      entities.end());
+  if (entityIndices.Contains(entity.GetId())) {
+    const size_t index = entityIndices.Remove(entity.GetId());
+    entities[index] = entities.back();
+    entities.pop_back();
+  }
+}
+
+std::vector<Entity> System::GetSystemEntities() const {
+  std::vector<Entity> systemEntities;
+  systemEntities.reserve(entities.size());
+  for (auto handle : entities) {
+    systemEntities.push_back(registry->GetEntity(handle));
+  }
+  return systemEntities;
 }
 
-std::vector<Entity> System::GetSystemEntities() const { return entities; }
+Registry* System::GetRegistry() const { return registry; }
+
+CommandBuffer& System::GetCommandBuffer() const { return *commandBuffer; }
 
 const Signature& System::GetComponentSignature() const {
   return componentSignature;
 }
 
+bool System::IsExclusive() const {
+  return readSignature.none() && writeSignature.none();
+}
+
+const Signature& System::GetReadSignature() const { return readSignature; }
+
+const Signature& System::GetWriteSignature() const { return writeSignature; }
+
+Registry::Registry(StorageBackend storageBackend) {
+  if (storageBackend == StorageBackend::Archetypes) {
+    archetypeStorage = std::make_unique<ArchetypeStorage>();
+  }
+  Logger::Log(LOG_CLASS_TAG, "Registry contructor called");
+}
+
+Registry::~Registry() {
+  Logger::Log(LOG_CLASS_TAG, "Registry destructor called");
+}
+
+StorageBackend Registry::GetStorageBackend() const {
+  return archetypeStorage ? StorageBackend::Archetypes : StorageBackend::Pools;
+}
+
+// Ids past the limit would overflow into the generation bits and alias
+// live handles, so there is no way to carry on.
+[[noreturn]] void Registry::OnEntityLimitReached() const {
+  Logger::Err(LOG_CLASS_TAG, "Entity limit of " +
+                                 std::to_string(EntityHandle::MAX_ENTITIES) +
+                                 " reached");
+  std::abort();
+}
+
 Entity Registry::CreateEntity() {
   size_t entityId = 0;
   if (freeIds.empty()) {
+    if (numEntities >= EntityHandle::MAX_ENTITIES) {
+      OnEntityLimitReached();
+    }
     entityId = numEntities++;
     if (entityId >= entityComponentSignatures.size()) {
       entityComponentSignatures.resize(entityId + 1);
+      entityGenerations.resize(entityId + 1, 0);
+      entityIsActive.resize(entityId + 1, false);
     }
   } else {
     entityId = freeIds.front();
     freeIds.pop_front();
   }
 
-  Entity entity(entityId);
+  Entity entity(GetEntityHandle(entityId));
   entity.registry = this;
-  entitiesToBeAdded.insert(entity);
+  entitiesToBeAdded.push_back(entity.GetHandle());
   Logger::Log(LOG_CLASS_TAG,
               "Entity created with id = " + std::to_string(entityId));
   return entity;
 }
 
+std::vector<Entity> Registry::CreateEntities(size_t count) {
+  std::vector<Entity> entities;
+  entities.reserve(count);
+
+  const size_t numRecycled = std::min(count, freeIds.size());
+  const size_t firstNewId = numEntities;
+  if (numEntities + (count - numRecycled) > EntityHandle::MAX_ENTITIES) {
+    OnEntityLimitReached();
+  }
+  numEntities += count - numRecycled;
+  if (numEntities > entityComponentSignatures.size()) {
+    entityComponentSignatures.resize(numEntities);
+    entityGenerations.resize(numEntities, 0);
+    entityIsActive.resize(numEntities, false);
+  }
+
+  entitiesToBeAdded.reserve(entitiesToBeAdded.size() + count);
+  for (size_t i = 0; i < count; i++) {
+    size_t entityId = 0;
+    if (i < numRecycled) {
+      entityId = freeIds.front();
+      freeIds.pop_front();
+    } else {
+      entityId = firstNewId + i - numRecycled;
+    }
+    entities.push_back(GetEntity(GetEntityHandle(entityId)));
+    entitiesToBeAdded.push_back(entities.back().GetHandle());
+  }
+
+  Logger::Log(LOG_CLASS_TAG,
+              std::to_string(count) + " entities created in bulk");
+  return entities;
+}
+
 void Registry::KillEntity(Entity entity) {
-  entitiesToBeKilled.insert(entity);
+  if (!IsAlive(entity.GetHandle())) {
+    return;
+  }
+  entitiesToBeKilled.push_back(entity.GetHandle());
   Logger::Log(LOG_CLASS_TAG,
               "Entity killed with id = " + std::to_string(entity.GetId()));
 }
 
-void Registry::Update() {
-  for (auto entity : entitiesToBeAdded) {
-    AddEntityToSystem(entity);
+CommandBuffer& Registry::CreateCommandBuffer() {
+  commandBuffers.push_back(std::make_unique<CommandBuffer>());
+  return *commandBuffers.back();
+}
+
+uint32_t Registry::GetTick() const { return currentTick; }
+
+RegistryStats Registry::GetStats() const {
+  RegistryStats stats;
+  stats.tick = currentTick;
+  stats.numEntities = numEntities;
+  stats.numFreeIds = freeIds.size();
+  stats.numPendingAdds = entitiesToBeAdded.size();
+  stats.numPendingKills = entitiesToBeKilled.size();
+  for (const auto& handle : entityPerTag) {
+    if (IsAlive(handle)) {
+      stats.numTags++;
+    }
   }
-  entitiesToBeAdded.clear();
+  stats.tagTableSize = entityPerTag.size();
+  for (const auto& members : entitiesPerGroup) {
+    stats.numGroupMembers += members.GetSize();
+  }
+  stats.groupTableSize = entitiesPerGroup.size();
+  stats.numPrefabs = prefabs.size();
+  stats.arenaBytesReserved = poolArena.GetBytesReserved();
+  stats.arenaBlockCount = poolArena.GetAllocationCount();
 
-  for (auto entity : entitiesToBeKilled) {
-    RemoveEntityFromSystem(entity);
-    entityComponentSignatures[entity.GetId()].reset();
+  for (size_t componentId = 0; componentId < componentPools.size();
+       componentId++) {
+    const auto& pool = componentPools[componentId];
+    if (!pool) {
+      continue;
+    }
+    PoolStats poolStats;
+    poolStats.componentName = IComponent::GetTypeName(componentId);
+    poolStats.size = pool->GetSize();
+    poolStats.capacity = pool->GetCapacity();
+    poolStats.bytesUsed = poolStats.size * pool->GetComponentSize();
+    poolStats.bytesWasted =
+        (poolStats.capacity - poolStats.size) * pool->GetComponentSize();
+    poolStats.indexBytes = pool->GetIndexBytes();
+    stats.pools.push_back(poolStats);
+  }
 
-    for (auto pool : componentPools) {
-      if (pool) {
-        pool->RemoveEntityFromPool(entity.GetId());
-      }
+  for (const auto& [type, system] : systems) {
+    stats.systems.push_back({type.name(), system->entities.size()});
+  }
+  std::sort(stats.systems.begin(), stats.systems.end(),
+            [](const SystemStats& a, const SystemStats& b) {
+              return a.systemName < b.systemName;
+            });
+  return stats;
+}
+
+void Registry::OnComponentChanged(size_t entityId, size_t componentId) const {
+  if (trackedComponents.test(componentId)) {
+    auto& ticks = changeTicks[componentId];
+    if (entityId >= ticks.size()) {
+      ticks.resize(entityId + 1, 0);
     }
+    ticks[entityId] = currentTick;
+  }
+  if (orderedComponents.test(componentId)) {
+    unsortedComponents.set(componentId);
+  }
+}
 
-    freeIds.push_back(entity.GetId());
+void Registry::Update() {
+  currentTick++;
 
-    RemoveEntityTag(entity);
-    RemoveEntityGroup(entity);
+  for (auto& commandBuffer : commandBuffers) {
+    if (!commandBuffer->IsEmpty()) {
+      commandBuffer->Apply(*this);
+    }
   }
+
+  AddEntitiesToSystems(entitiesToBeAdded);
+  entitiesToBeAdded.clear();
+
+  DestroyEntities(entitiesToBeKilled);
   entitiesToBeKilled.clear();
 }
 
-void Registry::AddEntityToSystem(Entity entity) {
+void Registry::OnComponentAdded(size_t entityId) {
+  for (auto& group : componentGroups) {
+    group->OnComponentAdded(entityId, entityComponentSignatures[entityId]);
+  }
+}
+
+void Registry::OnComponentRemoving(size_t entityId, size_t componentId) {
+  for (auto& group : componentGroups) {
+    if (group->GetSignature().test(componentId)) {
+      group->OnComponentRemoving(entityId);
+    }
+  }
+}
+
+bool Registry::IsAlive(EntityHandle handle) const {
+  const auto entityId = handle.GetIndex();
+  return entityId < numEntities &&
+         entityGenerations[entityId] == handle.GetGeneration();
+}
+
+bool Registry::HasComponent(Entity entity, size_t componentId) const {
   const auto entityId = entity.GetId();
-  const auto entityComponentSignature = entityComponentSignatures[entityId];
+  return entityId < entityComponentSignatures.size() &&
+         entityComponentSignatures[entityId].test(componentId);
+}
+
+Entity Registry::GetEntity(EntityHandle handle) const {
+  Entity entity(handle);
+  entity.registry = const_cast<Registry*>(this);
+  return entity;
+}
+
+EntityHandle Registry::GetEntityHandle(size_t entityId) const {
+  return EntityHandle(entityId, entityGenerations[entityId]);
+}
+
+void Registry::AddEntitiesToSystems(const std::vector<EntityHandle>& entities) {
+  for (auto handle : entities) {
+    entityIsActive[handle.GetIndex()] = true;
+  }
   for (auto& system : systems) {
     const auto& systemComponentSignature =
         system.second->GetComponentSignature();
-    bool isInterested = (entityComponentSignature & systemComponentSignature) ==
-                        systemComponentSignature;
-    if (isInterested) {
-      system.second->AddEntityToSystem(entity);
+    for (auto handle : entities) {
+      const auto& entityComponentSignature =
+          entityComponentSignatures[handle.GetIndex()];
+      bool isInterested =
+          (entityComponentSignature & systemComponentSignature) ==
+          systemComponentSignature;
+      if (isInterested) {
+        system.second->AddEntityToSystem(GetEntity(handle));
+      }
     }
   }
 }
 
-void Registry::RemoveEntityFromSystem(Entity entity) {
+void Registry::OnSignatureChanged(size_t entityId,
+                                  const Signature& oldSignature) {
+  if (!entityIsActive[entityId]) {
+    return;
+  }
+  const auto& newSignature = entityComponentSignatures[entityId];
   for (auto& system : systems) {
-    system.second->RemoveEntityFromSystem(entity);
+    const auto& systemComponentSignature =
+        system.second->GetComponentSignature();
+    const bool wasInterested =
+        (oldSignature & systemComponentSignature) == systemComponentSignature;
+    const bool isInterested =
+        (newSignature & systemComponentSignature) == systemComponentSignature;
+    if (isInterested && !wasInterested) {
+      system.second->AddEntityToSystem(GetEntity(GetEntityHandle(entityId)));
+    } else if (wasInterested && !isInterested) {
+      system.second->RemoveEntityFromSystem(
+          GetEntity(GetEntityHandle(entityId)));
+    }
   }
 }
 
-// Tag management
-void Registry::TagEntity(Entity entity, const std::string& tag) {
-  entityPerTag.emplace(tag, entity);
-  tagPerEntity.emplace(entity.GetId(), tag);
+// Kills are processed as one batch. Each dying entity only visits the
+// systems, groups and pools its signature names, and every pool removes all
+// of its dying entities in a single call.
+void Registry::DestroyEntities(const std::vector<EntityHandle>& entities) {
+  // Bumping the generation up front turns duplicate kills into stale
+  // handles.
+  dyingEntities.clear();
+  for (auto handle : entities) {
+    if (!IsAlive(handle)) {
+      continue;
+    }
+    auto& generation = entityGenerations[handle.GetIndex()];
+    generation = (generation + 1) & EntityHandle::GENERATION_MASK;
+    dyingEntities.push_back(handle);
+  }
+
+  Signature dyingComponents;
+  for (auto handle : dyingEntities) {
+    const size_t entityId = handle.GetIndex();
+    const Signature& signature = entityComponentSignatures[entityId];
+    if (entityIsActive[entityId]) {
+      for (auto& system : systems) {
+        const auto& systemComponentSignature =
+            system.second->GetComponentSignature();
+        if ((signature & systemComponentSignature) ==
+            systemComponentSignature) {
+          system.second->RemoveEntityFromSystem(Entity(handle));
+        }
+      }
+    }
+
+    ForEachComponentId(signature, [this, handle](size_t componentId) {
+      componentSignals[componentId].onDestroy.Emit(GetEntity(handle));
+    });
+
+    if (archetypeStorage) {
+      archetypeStorage->RemoveEntity(entityId);
+    } else {
+      for (auto& group : componentGroups) {
+        if ((signature & group->GetSignature()) == group->GetSignature()) {
+          group->OnComponentRemoving(entityId);
+        }
+      }
+      ForEachComponentId(signature, [this, entityId](size_t componentId) {
+        dyingEntitiesPerComponent[componentId].push_back(entityId);
+      });
+      dyingComponents |= signature;
+    }
+  }
+
+  // Swap-removal breaks the order of sorted pools.
+  unsortedComponents |= dyingComponents & orderedComponents;
+  ForEachComponentId(dyingComponents, [this](size_t componentId) {
+    // Empty components have no pool.
+    if (componentId < componentPools.size() && componentPools[componentId]) {
+      componentPools[componentId]->RemoveEntitiesFromPool(
+          dyingEntitiesPerComponent[componentId]);
+    }
+    dyingEntitiesPerComponent[componentId].clear();
+  });
+
+  for (auto handle : dyingEntities) {
+    Entity entity(handle);
+    entityComponentSignatures[entity.GetId()].reset();
+    entityIsActive[entity.GetId()] = false;
+    freeIds.push_back(entity.GetId());
+    RemoveEntityTag(entity);
+    RemoveEntityGroup(entity);
+  }
+}
+
+namespace {
+const uint32_t SNAPSHOT_MAGIC = 0x53434531;  // "ECS1"
+const uint32_t SNAPSHOT_VERSION = 3;
+
+void WriteHandles(BinaryWriter& writer,
+                  const std::vector<EntityHandle>& handles) {
+  writer.Write(static_cast<uint32_t>(handles.size()));
+  writer.WriteBytes(handles.data(), handles.size() * sizeof(EntityHandle));
 }
 
-bool Registry::EntityHasTag(Entity entity, const std::string& tag) const {
-  if (tagPerEntity.find(entity.GetId()) == tagPerEntity.end()) {
+bool ReadHandles(BinaryReader& reader, size_t numEntities,
+                 std::vector<EntityHandle>& handles) {
+  uint32_t count = 0;
+  if (!reader.Read(count) ||
+      reader.GetRemaining() / sizeof(EntityHandle) < count) {
     return false;
   }
-  return entityPerTag.find(tag)->second == entity;
+  handles.resize(count);
+  reader.ReadBytes(handles.data(), count * sizeof(EntityHandle));
+  for (auto handle : handles) {
+    if (handle.GetIndex() >= numEntities) {
+      return false;
+    }
+  }
+  return true;
 }
+}  // namespace
 
-Entity Registry::GetEntityByTag(const std::string& tag) const {
-  return entityPerTag.at(tag);
+// Snapshot management
+std::vector<uint8_t> Registry::Serialize() const {
+  std::vector<uint8_t> blob;
+  Serialize(blob);
+  return blob;
 }
 
-void Registry::RemoveEntityTag(Entity entity) {
-  auto taggedEntity = tagPerEntity.find(entity.GetId());
-  if (taggedEntity != tagPerEntity.end()) {
-    auto tag = taggedEntity->second;
-    entityPerTag.erase(tag);
-    tagPerEntity.erase(taggedEntity);
+void Registry::Serialize(std::vector<uint8_t>& blob) const {
+  blob.clear();
+  if (archetypeStorage) {
+    Logger::Err(LOG_CLASS_TAG, "Snapshots need the pool storage backend");
+    return;
+  }
+  for (size_t componentId = 0; componentId < componentPools.size();
+       componentId++) {
+    const auto& pool = componentPools[componentId];
+    if (pool && !pool->IsSerializable()) {
+      Logger::Err(LOG_CLASS_TAG, "No ComponentSerializer for " +
+                                     IComponent::GetTypeName(componentId));
+      return;
+    }
+  }
+
+  BinaryWriter writer(blob);
+  writer.Write(SNAPSHOT_MAGIC);
+  writer.Write(SNAPSHOT_VERSION);
+  writer.Write(currentTick);
+  writer.Write(static_cast<uint32_t>(numEntities));
+
+  writer.WriteBytes(entityGenerations.data(), numEntities * sizeof(uint32_t));
+  for (size_t entityId = 0; entityId < numEntities; entityId++) {
+    writer.Write(
+        static_cast<uint32_t>(entityComponentSignatures[entityId].to_ulong()));
+  }
+  for (size_t entityId = 0; entityId < numEntities; entityId++) {
+    writer.Write(static_cast<uint8_t>(entityIsActive[entityId]));
   }
+
+  writer.Write(static_cast<uint32_t>(freeIds.size()));
+  for (auto entityId : freeIds) {
+    writer.Write(static_cast<uint32_t>(entityId));
+  }
+  WriteHandles(writer, entitiesToBeAdded);
+  WriteHandles(writer, entitiesToBeKilled);
+
+  // Tag and group ids are only stable within a process, so they are
+  // stored by name.
+  uint32_t numTags = 0;
+  for (auto handle : entityPerTag) {
+    numTags += IsAlive(handle);
+  }
+  writer.Write(numTags);
+  for (TagId tag = 0; tag < entityPerTag.size(); tag++) {
+    if (IsAlive(entityPerTag[tag])) {
+      writer.WriteString(GetTagName(tag));
+      writer.Write(entityPerTag[tag]);
+    }
+  }
+  uint32_t numGroups = 0;
+  for (const auto& group : entitiesPerGroup) {
+    numGroups += !group.IsEmpty();
+  }
+  writer.Write(numGroups);
+  for (GroupId group = 0; group < entitiesPerGroup.size(); group++) {
+    const auto& members = entitiesPerGroup[group].GetEntities();
+    if (!members.empty()) {
+      writer.WriteString(GetGroupName(group));
+      writer.Write(static_cast<uint32_t>(members.size()));
+      for (auto entityId : members) {
+        writer.Write(static_cast<uint32_t>(entityId));
+      }
+    }
+  }
+
+  uint32_t numPools = 0;
+  Signature pooledComponents;
+  for (size_t componentId = 0; componentId < componentPools.size();
+       componentId++) {
+    if (componentPools[componentId]) {
+      numPools++;
+      pooledComponents.set(componentId);
+    }
+  }
+  writer.Write(numPools);
+  for (size_t componentId = 0; componentId < componentPools.size();
+       componentId++) {
+    if (componentPools[componentId]) {
+      writer.WriteString(IComponent::GetTypeName(componentId));
+      componentPools[componentId]->Serialize(writer);
+    }
+  }
+
+  // Empty components live only in the signatures; name the ones in use so
+  // the loader can map their ids.
+  Signature emptyComponents;
+  for (size_t entityId = 0; entityId < numEntities; entityId++) {
+    emptyComponents |= entityComponentSignatures[entityId];
+  }
+  emptyComponents &= ~pooledComponents;
+  writer.Write(static_cast<uint32_t>(emptyComponents.count()));
+  ForEachComponentId(emptyComponents, [&writer](size_t componentId) {
+    writer.WriteString(IComponent::GetTypeName(componentId));
+  });
 }
 
-// Group management
-void Registry::GroupEntity(Entity entity, const std::string& group) {
-  entitiesPerGroup.emplace(group, std::set<Entity>());
-  entitiesPerGroup[group].emplace(entity);
-  groupPerEntity.emplace(entity.GetId(), group);
+bool Registry::Deserialize(const std::vector<uint8_t>& blob) {
+  ClearEntities();
+  if (archetypeStorage) {
+    Logger::Err(LOG_CLASS_TAG, "Snapshots need the pool storage backend");
+    return false;
+  }
+
+  BinaryReader reader(blob.data(), blob.size());
+  if (!ReadSnapshot(reader)) {
+    ClearEntities();
+    Logger::Err(LOG_CLASS_TAG, "Malformed snapshot");
+    return false;
+  }
+
+  for (auto& group : componentGroups) {
+    group->Rebuild();
+  }
+  std::vector<EntityHandle> activeEntities;
+  for (size_t entityId = 0; entityId < numEntities; entityId++) {
+    if (entityIsActive[entityId]) {
+      activeEntities.push_back(GetEntityHandle(entityId));
+    }
+  }
+  AddEntitiesToSystems(activeEntities);
+  Logger::Log(LOG_CLASS_TAG, "Snapshot loaded with " +
+                                 std::to_string(numEntities) + " entities");
+  return true;
+}
+
+bool Registry::ReadSnapshot(BinaryReader& reader) {
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint32_t count = 0;
+  reader.Read(magic);
+  reader.Read(version);
+  reader.Read(currentTick);
+  reader.Read(count);
+  if (reader.HasFailed() || magic != SNAPSHOT_MAGIC ||
+      version != SNAPSHOT_VERSION || count > EntityHandle::MAX_ENTITIES ||
+      reader.GetRemaining() / (2 * sizeof(uint32_t) + 1) < count) {
+    return false;
+  }
+
+  numEntities = count;
+  entityGenerations.resize(numEntities);
+  entityComponentSignatures.resize(numEntities);
+  entityIsActive.resize(numEntities);
+  reader.ReadBytes(entityGenerations.data(), numEntities * sizeof(uint32_t));
+  for (size_t entityId = 0; entityId < numEntities; entityId++) {
+    uint32_t signature = 0;
+    reader.Read(signature);
+    entityComponentSignatures[entityId] = Signature(signature);
+  }
+  for (size_t entityId = 0; entityId < numEntities; entityId++) {
+    uint8_t isActive = 0;
+    reader.Read(isActive);
+    entityIsActive[entityId] = isActive != 0;
+  }
+
+  if (!reader.Read(count) || reader.GetRemaining() / sizeof(uint32_t) < count) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t entityId = 0;
+    reader.Read(entityId);
+    if (entityId >= numEntities) {
+      return false;
+    }
+    freeIds.push_back(entityId);
+  }
+  if (!ReadHandles(reader, numEntities, entitiesToBeAdded) ||
+      !ReadHandles(reader, numEntities, entitiesToBeKilled)) {
+    return false;
+  }
+
+  std::string name;
+  if (!reader.Read(count)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    EntityHandle handle;
+    if (!reader.ReadString(name) || !reader.Read(handle) ||
+        !IsAlive(handle)) {
+      return false;
+    }
+    TagEntity(GetEntity(handle), GetTagId(name));
+  }
+  if (!reader.Read(count)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t numMembers = 0;
+    if (!reader.ReadString(name) || !reader.Read(numMembers)) {
+      return false;
+    }
+    const GroupId group = GetGroupId(name);
+    for (uint32_t j = 0; j < numMembers; j++) {
+      uint32_t entityId = 0;
+      if (!reader.Read(entityId) || entityId >= numEntities) {
+        return false;
+      }
+      GroupEntity(GetEntity(GetEntityHandle(entityId)), group);
+    }
+  }
+
+  if (!reader.Read(count)) {
+    return false;
+  }
+  Signature loadedComponents;
+  for (uint32_t i = 0; i < count; i++) {
+    if (!reader.ReadString(name)) {
+      return false;
+    }
+    const size_t componentId = IComponent::FindId(name);
+    if (componentId >= MAX_COMPONENTS) {
+      Logger::Err(LOG_CLASS_TAG, "Snapshot names unknown component " + name);
+      return false;
+    }
+    if (componentId >= componentPools.size()) {
+      componentPools.resize(componentId + 1);
+    }
+    auto& pool = componentPools[componentId];
+    if (!pool) {
+      pool = IComponent::CreatePool(componentId, &poolArena);
+    }
+    if (!pool || !pool->Deserialize(reader, numEntities)) {
+      return false;
+    }
+    loadedComponents.set(componentId);
+  }
+  if (!reader.Read(count)) {
+    return false;
+  }
+  Signature emptyComponents;
+  for (uint32_t i = 0; i < count; i++) {
+    if (!reader.ReadString(name)) {
+      return false;
+    }
+    const size_t componentId = IComponent::FindId(name);
+    if (componentId >= MAX_COMPONENTS || !IComponent::IsEmpty(componentId)) {
+      Logger::Err(LOG_CLASS_TAG, "Snapshot names unknown empty component " +
+                                     name);
+      return false;
+    }
+    emptyComponents.set(componentId);
+  }
+
+  // Every signature bit must be backed by a pool entry and vice versa,
+  // except for empty components.
+  std::array<size_t, MAX_COMPONENTS> numOwners{};
+  for (const auto& signature : entityComponentSignatures) {
+    if ((signature & ~(loadedComponents | emptyComponents)).any()) {
+      return false;
+    }
+    ForEachComponentId(signature, [&numOwners](size_t componentId) {
+      numOwners[componentId]++;
+    });
+  }
+  bool isConsistent = true;
+  ForEachComponentId(loadedComponents, [&](size_t componentId) {
+    const auto* pool = componentPools[componentId].get();
+    if (pool->GetSize() != numOwners[componentId]) {
+      isConsistent = false;
+      return;
+    }
+    for (auto entityId : pool->GetEntities()) {
+      if (!entityComponentSignatures[entityId].test(componentId)) {
+        isConsistent = false;
+        return;
+      }
+    }
+  });
+  return isConsistent;
+}
+
+void Registry::ClearEntities() {
+  for (auto& system : systems) {
+    system.second->entityIndices.Clear();
+    system.second->entities.clear();
+  }
+  for (auto& pool : componentPools) {
+    if (pool) {
+      pool->Clear();
+    }
+  }
+  for (auto& group : componentGroups) {
+    group->Rebuild();
+  }
+  for (auto& ticks : changeTicks) {
+    ticks.clear();
+  }
+  unsortedComponents |= orderedComponents;
+  numEntities = 0;
+  freeIds.clear();
+  entityGenerations.clear();
+  entityComponentSignatures.clear();
+  entityIsActive.clear();
+  entitiesToBeAdded.clear();
+  entitiesToBeKilled.clear();
+  entityPerTag.clear();
+  tagPerEntity.clear();
+  entitiesPerGroup.clear();
+  groupPerEntity.clear();
+}
+
+void Registry::Clear() {
+  ClearEntities();
+  for (auto& pool : componentPools) {
+    if (pool) {
+      pool->ReleaseChunks();
+    }
+  }
+  for (auto& pool : prefabPools) {
+    if (pool) {
+      pool->ReleaseChunks();
+    }
+  }
+  prefabs.clear();
+  if (archetypeStorage) {
+    archetypeStorage = std::make_unique<ArchetypeStorage>();
+  }
+  poolArena.Release();
+  Logger::Log(LOG_CLASS_TAG, "Registry cleared");
+}
+
+// Prefab management
+PrefabId Registry::CreatePrefab() {
+  prefabs.emplace_back();
+  Logger::Log(LOG_CLASS_TAG, "Prefab created with id = " +
+                                 std::to_string(prefabs.size() - 1));
+  return static_cast<PrefabId>(prefabs.size() - 1);
+}
+
+void Registry::SetPrefabGroup(PrefabId prefab, GroupId group) {
+  if (IsPrefab(prefab)) {
+    prefabs[prefab].group = group;
+  }
+}
+
+std::vector<Entity> Registry::InstantiateMany(PrefabId prefab, size_t count) {
+  assert(IsPrefab(prefab));
+  std::vector<Entity> entities = CreateEntities(count);
+  std::vector<size_t> entityIds;
+  entityIds.reserve(count);
+  for (auto entity : entities) {
+    entityIds.push_back(entity.GetId());
+  }
+  CopyPrefabComponents(prefab, entityIds.data(), count);
+  OnEntitiesInstantiated(prefab, prefabs[prefab].signature, entities.data(),
+                         count);
+  return entities;
+}
+
+bool Registry::IsPrefab(PrefabId prefab) const {
+  if (prefab >= prefabs.size()) {
+    Logger::Err(LOG_CLASS_TAG, "Unknown prefab id " + std::to_string(prefab));
+    return false;
+  }
+  return true;
 }
 
-bool Registry::EntityBelongsToGroup(Entity entity,
-                                    const std::string& group) const {
-  auto groupEntities = entitiesPerGroup.at(group);
-  return groupEntities.find(entity.GetId()) != groupEntities.end();
+void Registry::CopyPrefabComponents(PrefabId prefab, const size_t* entityIds,
+                                    size_t count) {
+  ForEachComponentId(
+      prefabs[prefab].signature,
+      [this, prefab, entityIds, count](size_t componentId) {
+        // Empty components have no pool and need only the signature bit.
+        if (componentId >= prefabPools.size() || !prefabPools[componentId]) {
+          return;
+        }
+        const IPool& source = *prefabPools[componentId];
+        if (archetypeStorage) {
+          for (size_t i = 0; i < count; i++) {
+            source.CopyComponent(prefab, *archetypeStorage, entityIds[i],
+                                 componentId);
+          }
+          return;
+        }
+        if (componentId >= componentPools.size()) {
+          componentPools.resize(componentId + 1, nullptr);
+        }
+        auto& pool = componentPools[componentId];
+        if (!pool) {
+          pool = IComponent::CreatePool(componentId, &poolArena);
+        }
+        source.CopyComponent(prefab, *pool, entityIds, count);
+      });
+}
+
+void Registry::OnEntitiesInstantiated(PrefabId prefab,
+                                      const Signature& signature,
+                                      const Entity* entities, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    const size_t entityId = entities[i].GetId();
+    const Signature oldSignature = entityComponentSignatures[entityId];
+    entityComponentSignatures[entityId] |= signature;
+    if (!archetypeStorage && !componentGroups.empty()) {
+      OnComponentAdded(entityId);
+    }
+    OnSignatureChanged(entityId, oldSignature);
+  }
+  if (prefabs[prefab].group != INVALID_NAME_ID) {
+    for (size_t i = 0; i < count; i++) {
+      GroupEntity(entities[i], prefabs[prefab].group);
+    }
+  }
+  ForEachComponentId(signature, [this, entities, count](size_t componentId) {
+    const auto& signals = componentSignals[componentId];
+    for (size_t i = 0; i < count; i++) {
+      MarkChanged(entities[i].GetId(), componentId);
+      signals.onConstruct.Emit(entities[i]);
+    }
+  });
+
+  Logger::Log(LOG_CLASS_TAG, "Prefab id " + std::to_string(prefab) +
+                                 " was instantiated as " +
+                                 std::to_string(count) + " entities");
 }
 
-std::vector<Entity> Registry::GetEntitiesByGroup(
-    const std::string& group) const {
-  auto setOfEntities = entitiesPerGroup.at(group);
-  return std::vector<Entity>(setOfEntities.begin(), setOfEntities.end());
+// Tag management
+void Registry::TagEntity(Entity entity, TagId tag) {
+  if (tag >= entityPerTag.size()) {
+    entityPerTag.resize(tag + 1);
+  }
+  if (entity.GetId() >= tagPerEntity.size()) {
+    tagPerEntity.resize(entity.GetId() + 1, INVALID_NAME_ID);
+  }
+  // First come, first served, on both sides.
+  if (IsAlive(entityPerTag[tag]) ||
+      tagPerEntity[entity.GetId()] != INVALID_NAME_ID) {
+    return;
+  }
+  entityPerTag[tag] = entity.GetHandle();
+  tagPerEntity[entity.GetId()] = tag;
+}
+
+bool Registry::EntityHasTag(Entity entity, TagId tag) const {
+  return tag < entityPerTag.size() && entityPerTag[tag] == entity.GetHandle();
+}
+
+Entity Registry::GetEntityByTag(TagId tag) const {
+  return GetEntity(tag < entityPerTag.size() ? entityPerTag[tag]
+                                             : EntityHandle());
+}
+
+void Registry::RemoveEntityTag(Entity entity) {
+  if (entity.GetId() < tagPerEntity.size()) {
+    auto& tag = tagPerEntity[entity.GetId()];
+    if (tag != INVALID_NAME_ID) {
+      entityPerTag[tag] = EntityHandle();
+      tag = INVALID_NAME_ID;
+    }
+  }
+}
+
+// Group management
+void Registry::GroupEntity(Entity entity, GroupId group) {
+  if (group >= entitiesPerGroup.size()) {
+    entitiesPerGroup.resize(group + 1);
+  }
+  if (entity.GetId() >= groupPerEntity.size()) {
+    groupPerEntity.resize(entity.GetId() + 1, INVALID_NAME_ID);
+  }
+  if (groupPerEntity[entity.GetId()] != INVALID_NAME_ID) {
+    return;
+  }
+  entitiesPerGroup[group].Insert(entity.GetId());
+  groupPerEntity[entity.GetId()] = group;
+}
+
+bool Registry::EntityBelongsToGroup(Entity entity, GroupId group) const {
+  return entity.GetId() < groupPerEntity.size() &&
+         groupPerEntity[entity.GetId()] == group && IsAlive(entity.GetHandle());
 }
 
 void Registry::RemoveEntityGroup(Entity entity) {
-  auto groupedEntity = groupPerEntity.find(entity.GetId());
-  if (groupedEntity != groupPerEntity.end()) {
-    auto group = entitiesPerGroup.find(groupedEntity->second);
-    if (group != entitiesPerGroup.end()) {
-      auto entityInGroup = group->second.find(entity);
-      if (entityInGroup != group->second.end()) {
-        group->second.erase(entityInGroup);
-      }
+  if (entity.GetId() < groupPerEntity.size()) {
+    auto& group = groupPerEntity[entity.GetId()];
+    if (group != INVALID_NAME_ID) {
+      entitiesPerGroup[group].Remove(entity.GetId());
+      group = INVALID_NAME_ID;
     }
-    groupPerEntity.erase(groupedEntity);
   }
 }
@@ -1,23 +1,83 @@
 #pragma once
 
-#include <bitset>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
 #include <deque>
+#include <functional>
 #include <memory>
-#include <set>
+#include <new>
+#include <string>
+#include <tuple>
+#include <type_traits>
 #include <typeindex>
 #include <unordered_map>
 #include <vector>
 
 #include "../Logger/Logger.h"
+#include "ArchetypeStorage.h"
+#include "PoolArena.h"
+#include "RegistryStats.h"
+#include "Serialization.h"
+#include "Signature.h"
+#include "SparseSet.h"
+
+// Compact reference to an entity: the low bits index the registry's entity
+// arrays and the high bits hold the generation of that index. Killing an
+// entity bumps the generation, so handles kept across frames can be checked
+// with Registry::IsAlive before use. Generations wrap after 4096 reuses.
+class EntityHandle {
+ public:
+  static constexpr uint32_t INDEX_BITS = 20;
+  static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+  static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+  static constexpr uint32_t MAX_ENTITIES = INDEX_MASK;
+
+  EntityHandle() : value(UINT32_MAX) {}
+  EntityHandle(uint32_t index, uint32_t generation)
+      : value(index | (generation << INDEX_BITS)) {}
+
+  uint32_t GetIndex() const { return value & INDEX_MASK; }
+  uint32_t GetGeneration() const { return value >> INDEX_BITS; }
+
+  bool operator==(const EntityHandle& other) const {
+    return value == other.value;
+  }
+  bool operator!=(const EntityHandle& other) const {
+    return value != other.value;
+  }
+  bool operator<(const EntityHandle& other) const {
+    return value < other.value;
+  }
+
+ private:
+  uint32_t value;
+};
+
+class CommandBuffer;
 
-const size_t MAX_COMPONENTS = 32;
-typedef std::bitset<MAX_COMPONENTS> Signature;
+// Tag and group names are interned to small dense ids, so checks compare
+// integers instead of strings. Interning is guarded by a lock; look the ids
+// up once, e.g. in a system's constructor, and keep them.
+typedef uint32_t TagId;
+typedef uint32_t GroupId;
+const uint32_t INVALID_NAME_ID = UINT32_MAX;
+TagId GetTagId(const std::string& tag);
+GroupId GetGroupId(const std::string& group);
+const std::string& GetTagName(TagId tag);
+const std::string& GetGroupName(GroupId group);
+
+// Index of a component template owned by one Registry.
+typedef uint32_t PrefabId;
 
 class Entity {
  public:
-  Entity(size_t id) : id(id) {}
+  Entity(EntityHandle handle) : handle(handle) {}
   Entity(const Entity& entity) = default;
   size_t GetId() const;
+  EntityHandle GetHandle() const;
+  bool IsAlive() const;
 
   template <typename TComponent, typename... TArgs>
   void AddComponent(TArgs&&... args);
@@ -27,44 +87,103 @@ class Entity {
   bool HasComponent() const;
   template <typename TComponent>
   TComponent& GetComponent() const;
+  template <typename TComponent>
+  const TComponent& ReadComponent() const;
+  template <typename TComponent, typename TFunction>
+  void Patch(TFunction function);
   void Kill();
 
   // Tag & Group management
-  void Tag(const std::string tag);
-  bool HasTag(const std::string tag) const;
-  void Group(const std::string group);
-  bool BelongsToGroup(const std::string group) const;
+  void Tag(TagId tag);
+  void Tag(const std::string& tag);
+  bool HasTag(TagId tag) const;
+  bool HasTag(const std::string& tag) const;
+  void Group(GroupId group);
+  void Group(const std::string& group);
+  bool BelongsToGroup(GroupId group) const;
+  bool BelongsToGroup(const std::string& group) const;
 
   Entity& operator=(const Entity& other) = default;
-  bool operator==(const Entity& other) const { return id == other.id; }
-  bool operator!=(const Entity& other) const { return id != other.id; }
-  bool operator<(const Entity& other) const { return id < other.id; }
-  bool operator>(const Entity& other) const { return id > other.id; }
+  bool operator==(const Entity& other) const { return handle == other.handle; }
+  bool operator!=(const Entity& other) const { return handle != other.handle; }
+  bool operator<(const Entity& other) const { return handle < other.handle; }
+  bool operator>(const Entity& other) const { return other.handle < handle; }
 
   class Registry* registry;
 
  private:
-  size_t id;
+  EntityHandle handle;
 };
 
+// Callbacks fired by the Registry when a component of one type is
+// constructed, updated or destroyed on an entity.
+class ComponentSignal {
+ public:
+  typedef std::function<void(Entity)> Listener;
+
+  void Connect(Listener listener) { listeners.push_back(std::move(listener)); }
+
+  void DisconnectAll() { listeners.clear(); }
+
+  bool IsEmpty() const { return listeners.empty(); }
+
+  void Emit(Entity entity) const {
+    for (auto& listener : listeners) {
+      listener(entity);
+    }
+  }
+
+ private:
+  std::vector<Listener> listeners;
+};
+
+class IPool;
+
+// Component ids are handed out on first use. Each type also records its
+// name and how to make a pool for it, so snapshots can refer to pools by
+// type name and recreate them. Empty types (markers such as
+// CameraFollowComponent) get no pool: with the pool backend they exist only
+// as Signature bits, so HasComponent is their only accessor.
 struct IComponent {
+  typedef std::shared_ptr<IPool> (*CreatePoolFunction)(PoolArena* arena);
+
+  static const std::string& GetTypeName(size_t componentId);
+  // Returns MAX_COMPONENTS for a name not used in this process.
+  static size_t FindId(const std::string& typeName);
+  static bool IsEmpty(size_t componentId);
+  // Returns nullptr for empty types.
+  static std::shared_ptr<IPool> CreatePool(size_t componentId,
+                                           PoolArena* arena);
+
  protected:
-  static size_t nextId;
+  static size_t Register(const char* typeName, CreatePoolFunction createPool);
+
+ private:
+  struct TypeInfo {
+    std::string name;
+    CreatePoolFunction createPool;
+  };
+
+  static std::vector<TypeInfo>& GetTypes();
 };
 
 template <typename T>
 class Component : public IComponent {
  public:
   static size_t GetId() {
-    static auto id = nextId++;
+    static auto id = Register(
+        typeid(T).name(), std::is_empty_v<T> ? nullptr : &CreatePoolForType);
     return id;
   }
+
+ private:
+  static std::shared_ptr<IPool> CreatePoolForType(PoolArena* arena);
 };
 
 class System {
  public:
   System() = default;
-  ~System() = default;
+  virtual ~System() = default;
   void AddEntityToSystem(Entity entity);
   void RemoveEntityFromSystem(Entity entity);
   std::vector<Entity> GetSystemEntities() const;
@@ -72,111 +191,576 @@ class System {
   template <typename TComponent>
   void RequireComponent();
 
+  // Components the system's update touches, declared for SystemScheduler.
+  // A system that declares nothing is treated as exclusive: it may create,
+  // change or remove anything and never runs alongside another system.
+  template <typename TComponent>
+  void ReadsComponent();
+  template <typename TComponent>
+  void WritesComponent();
+  bool IsExclusive() const;
+  const Signature& GetReadSignature() const;
+  const Signature& GetWriteSignature() const;
+
+ protected:
+  // Called by Registry::AddSystem, on its thread, once GetRegistry is set.
+  // Look up groups and other registry state here, not in an Update that may
+  // run on a scheduler thread.
+  virtual void OnAdded() {}
+  class Registry* GetRegistry() const;
+  // Per-system buffer for structural changes made while running on a
+  // scheduler thread; applied by the next Registry::Update.
+  CommandBuffer& GetCommandBuffer() const;
+
  private:
+  friend class Registry;
+
   Signature componentSignature;
-  std::vector<Entity> entities;
+  Signature readSignature;
+  Signature writeSignature;
+  // Indexed set: entityIndices maps an entity id to its slot in entities,
+  // so adding and removing members are both O(1) swap operations.
+  SparseSet entityIndices;
+  std::vector<EntityHandle> entities;
+  class Registry* registry = nullptr;
+  CommandBuffer* commandBuffer = nullptr;
 };
 
 class IPool {
  public:
   virtual ~IPool() {}
-  virtual void RemoveEntityFromPool(int entityId) = 0;
+  virtual size_t GetSize() const = 0;
+  virtual const std::vector<size_t>& GetEntities() const = 0;
+  // Every entity in the list must be in the pool.
+  virtual void RemoveEntitiesFromPool(const std::vector<size_t>& entityIds) = 0;
+  virtual void Clear() = 0;
+  // Clears the pool and forgets its chunks, before the arena that holds
+  // them is released.
+  virtual void ReleaseChunks() = 0;
+
+  // Memory accounting for Registry::GetStats.
+  virtual size_t GetCapacity() const = 0;
+  virtual size_t GetComponentSize() const = 0;
+  virtual size_t GetIndexBytes() const = 0;
+
+  // Prefab support: copies this pool's component of sourceEntityId to each
+  // listed entity of target, which must be a pool of the same type, or to
+  // an entity of an archetype storage.
+  virtual void CopyComponent(size_t sourceEntityId, IPool& target,
+                             const size_t* entityIds, size_t count) const = 0;
+  virtual void CopyComponent(size_t sourceEntityId, ArchetypeStorage& target,
+                             size_t entityId, size_t componentId) const = 0;
+
+  // Snapshot support; see ComponentSerializer.
+  virtual bool IsSerializable() const = 0;
+  virtual void Serialize(BinaryWriter& writer) const = 0;
+  // Replaces the pool's contents; returns false on malformed input, e.g. an
+  // entity id outside [0, numEntities) or listed twice.
+  virtual bool Deserialize(BinaryReader& reader, size_t numEntities) = 0;
 };
 
+// Components live in fixed-size chunks taken from a PoolArena, so growing
+// the pool never moves existing components and references stay valid until
+// that component (or the one in the last slot) is removed. Pools created by
+// a Registry share its arena; a standalone pool owns one.
 template <typename T>
 class Pool : public IPool {
  public:
-  Pool(size_t capacity = 100) {
-    size = 0;
-    data.resize(capacity);
+  static constexpr size_t CHUNK_CAPACITY = 256;
+
+  Pool(size_t capacity = 100, PoolArena* arena = nullptr) : arena(arena) {
+    if (!arena) {
+      ownedArena = std::make_unique<PoolArena>();
+      this->arena = ownedArena.get();
+    }
+    Reserve(capacity);
   }
 
-  virtual ~Pool() = default;
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+
+  // Chunk memory belongs to the arena and is freed with it.
+  virtual ~Pool() { DestroyAll(); }
 
   bool IsEmpty() const { return size == 0; }
 
-  size_t GetSize() const { return size; }
+  size_t GetSize() const override { return size; }
 
-  void Clear() {
-    size = 0;
-    data.clear();
+  size_t GetCapacity() const override {
+    return chunks.size() * CHUNK_CAPACITY;
+  }
+
+  size_t GetComponentSize() const override { return sizeof(T); }
+
+  size_t GetIndexBytes() const override {
+    return entities.GetBytesReserved() + chunks.capacity() * sizeof(T*);
+  }
+
+  // Takes the chunks for capacity components from the arena up front, so
+  // growing to that size allocates nothing.
+  void Reserve(size_t capacity) {
+    chunks.reserve((capacity + CHUNK_CAPACITY - 1) / CHUNK_CAPACITY);
+    while (chunks.size() * CHUNK_CAPACITY < capacity) {
+      AddChunk();
+    }
+    entities.Reserve(capacity);
+  }
+
+  void Clear() override {
+    DestroyAll();
+    entities.Clear();
+  }
+
+  void ReleaseChunks() override {
+    Clear();
+    chunks.clear();
+    if (ownedArena) {
+      ownedArena->Release();
+    }
   }
 
   void Set(size_t entityId, T object) {
-    if (entityIdToIndex.find(entityId) != entityIdToIndex.end()) {
-      int index = entityIdToIndex[entityId];
-      data[index] = object;
+    if (entities.Contains(entityId)) {
+      (*this)[entities.IndexOf(entityId)] = std::move(object);
     } else {
-      int index = size;
-      entityIdToIndex.emplace(entityId, index);
-      indexToEntityId.emplace(index, entityId);
-      if (static_cast<long unsigned int>(index) >= data.capacity()) {
-        data.resize(data.capacity() * 2);
+      entities.Insert(entityId);
+      if (size == chunks.size() * CHUNK_CAPACITY) {
+        AddChunk();
       }
-      data[index] = object;
+      new (Slot(size)) T(std::move(object));
       size++;
     }
   }
 
-  void Remove(int entityId) {
-    int indexOfRemoved = entityIdToIndex[entityId];
-    int indexOfLast = size - 1;
-    data[indexOfRemoved] = data[indexOfLast];
+  void Remove(size_t entityId) {
+    const size_t indexOfRemoved = entities.Remove(entityId);
+    T& last = (*this)[size - 1];
+    if (indexOfRemoved != size - 1) {
+      (*this)[indexOfRemoved] = std::move(last);
+    }
+    last.~T();
+    size--;
+  }
+
+  void RemoveEntitiesFromPool(const std::vector<size_t>& entityIds) override {
+    for (auto entityId : entityIds) {
+      Remove(entityId);
+    }
+  }
+
+  // Copy-constructs source for every listed entity, replacing the values of
+  // entities already in the pool. New slots are filled in dense order, so
+  // for trivially copyable types this is a run of fixed-size copies.
+  void SetCopies(const T& source, const size_t* entityIds, size_t count) {
+    // An exact reserve per single copy would reallocate every time.
+    if (count > 1) {
+      Reserve(size + count);
+    }
+    for (size_t i = 0; i < count; i++) {
+      if (entities.Contains(entityIds[i])) {
+        (*this)[entities.IndexOf(entityIds[i])] = source;
+      } else {
+        entities.Insert(entityIds[i]);
+        if (size == chunks.size() * CHUNK_CAPACITY) {
+          AddChunk();
+        }
+        new (Slot(size)) T(source);
+        size++;
+      }
+    }
+  }
+
+  void CopyComponent(size_t sourceEntityId, IPool& target,
+                     const size_t* entityIds, size_t count) const override {
+    static_cast<Pool<T>&>(target).SetCopies(Get(sourceEntityId), entityIds,
+                                            count);
+  }
 
-    int entityIdOfLastElement = indexToEntityId[indexOfLast];
-    entityIdToIndex[entityIdOfLastElement] = indexOfRemoved;
-    indexToEntityId[indexOfRemoved] = entityIdOfLastElement;
+  void CopyComponent(size_t sourceEntityId, ArchetypeStorage& target,
+                     size_t entityId, size_t componentId) const override {
+    target.Set(entityId, componentId, T(Get(sourceEntityId)));
+  }
 
-    entityIdToIndex.erase(entityId);
-    indexToEntityId.erase(indexOfLast);
+  bool Contains(size_t entityId) const { return entities.Contains(entityId); }
 
-    size--;
+  size_t IndexOf(size_t entityId) const { return entities.IndexOf(entityId); }
+
+  // Exchanges two dense slots, keeping the id mapping in sync.
+  void Swap(size_t indexA, size_t indexB) {
+    if (indexA != indexB) {
+      std::swap((*this)[indexA], (*this)[indexB]);
+      entities.Swap(indexA, indexB);
+    }
   }
 
-  void RemoveEntityFromPool(int entityId) override {
-    if (entityIdToIndex.find(entityId) != entityIdToIndex.end()) {
-      Remove(entityId);
+  // Stable sort of the dense slots. Starts as an insertion sort, which is
+  // linear when the pool is nearly sorted, the common case between frames,
+  // and switches to a full sort once the moves exceed the pool size.
+  template <typename TCompare>
+  void Sort(TCompare compare) {
+    size_t moveBudget = size;
+    for (size_t i = 1; i < size; i++) {
+      for (size_t j = i; j > 0 && compare((*this)[j], (*this)[j - 1]); j--) {
+        Swap(j, j - 1);
+        if (--moveBudget == 0) {
+          SortFully(compare);
+          return;
+        }
+      }
     }
   }
 
-  T& Get(size_t entityId) {
-    return static_cast<T&>(data[entityIdToIndex[entityId]]);
+  T& Get(size_t entityId) { return (*this)[entities.IndexOf(entityId)]; }
+
+  const T& Get(size_t entityId) const {
+    return *Slot(entities.IndexOf(entityId));
   }
 
-  T& operator[](size_t index) { return data[index]; }
+  T& operator[](size_t index) { return *Slot(index); }
+
+  // Dense index i lives at GetChunk(i / CHUNK_CAPACITY)[i % CHUNK_CAPACITY].
+  size_t GetChunkCount() const { return chunks.size(); }
+
+  T* GetChunk(size_t chunk) { return chunks[chunk]; }
+
+  const std::vector<size_t>& GetEntities() const override {
+    return entities.GetEntities();
+  }
+
+  bool IsSerializable() const override {
+    return ComponentSerializer<T>::isSupported;
+  }
+
+  // Entity ids, then the components in dense order: whole chunks at a time
+  // for bulk serialized types, one by one through the serializer otherwise.
+  void Serialize(BinaryWriter& writer) const override {
+    if constexpr (ComponentSerializer<T>::isSupported) {
+      writer.Write(static_cast<uint32_t>(size));
+      for (auto entityId : entities.GetEntities()) {
+        writer.Write(static_cast<uint32_t>(entityId));
+      }
+      if constexpr (IsBulkSerialized<T>::value) {
+        for (size_t first = 0; first < size; first += CHUNK_CAPACITY) {
+          writer.WriteBytes(Slot(first),
+                            std::min(CHUNK_CAPACITY, size - first) * sizeof(T));
+        }
+      } else {
+        for (size_t i = 0; i < size; i++) {
+          ComponentSerializer<T>::Write(writer, *Slot(i));
+        }
+      }
+    }
+  }
+
+  bool Deserialize(BinaryReader& reader, size_t numEntities) override {
+    Clear();
+    if constexpr (ComponentSerializer<T>::isSupported) {
+      uint32_t count = 0;
+      if (!reader.Read(count) ||
+          reader.GetRemaining() / sizeof(uint32_t) < count) {
+        return false;
+      }
+      Reserve(count);
+      for (uint32_t i = 0; i < count; i++) {
+        uint32_t entityId = 0;
+        reader.Read(entityId);
+        if (entityId >= numEntities || entities.Contains(entityId)) {
+          entities.Clear();
+          return false;
+        }
+        entities.Insert(entityId);
+      }
+      if constexpr (IsBulkSerialized<T>::value) {
+        for (size_t first = 0; first < count; first += CHUNK_CAPACITY) {
+          const size_t chunkSize =
+              std::min<size_t>(CHUNK_CAPACITY, count - first);
+          if (!reader.ReadBytes(Slot(first), chunkSize * sizeof(T))) {
+            break;
+          }
+          size += chunkSize;
+        }
+      } else {
+        for (uint32_t i = 0; i < count && !reader.HasFailed(); i++) {
+          T component;
+          ComponentSerializer<T>::Read(reader, component);
+          new (Slot(size)) T(std::move(component));
+          size++;
+        }
+      }
+      if (reader.HasFailed()) {
+        Clear();
+        return false;
+      }
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  T* Slot(size_t index) {
+    return chunks[index / CHUNK_CAPACITY] + index % CHUNK_CAPACITY;
+  }
+
+  const T* Slot(size_t index) const {
+    return chunks[index / CHUNK_CAPACITY] + index % CHUNK_CAPACITY;
+  }
+
+  template <typename TCompare>
+  void SortFully(TCompare compare) {
+    // order[i] is the current index of the element that belongs at i.
+    std::vector<size_t> order(size);
+    for (size_t i = 0; i < size; i++) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [this, &compare](size_t a, size_t b) {
+                       return compare(*Slot(a), *Slot(b));
+                     });
+    // Apply the permutation cycle by cycle, one swap per misplaced slot.
+    for (size_t i = 0; i < size; i++) {
+      size_t current = i;
+      while (order[current] != i) {
+        const size_t next = order[current];
+        Swap(current, next);
+        order[current] = current;
+        current = next;
+      }
+      order[current] = current;
+    }
+  }
+
+  void AddChunk() {
+    chunks.push_back(static_cast<T*>(
+        arena->Allocate(CHUNK_CAPACITY * sizeof(T), alignof(T))));
+  }
+
+  void DestroyAll() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (size_t i = 0; i < size; i++) {
+        Slot(i)->~T();
+      }
+    }
+    size = 0;
+  }
+
+ private:
+  std::unique_ptr<PoolArena> ownedArena;
+  PoolArena* arena;
+  std::vector<T*> chunks;
+  size_t size = 0;
+  SparseSet entities;
+};
+
+template <typename T>
+std::shared_ptr<IPool> Component<T>::CreatePoolForType(PoolArena* arena) {
+  return std::make_shared<Pool<T>>(100, arena);
+}
+
+// Lists component types an EntityView must skip, e.g.
+// registry->View<TransformComponent>(Exclude<CameraFollowComponent>()).
+template <typename... TComponents>
+struct Exclude {};
+
+// Iterates every entity owning all of TComponents by walking the smallest of
+// their pools and handing the callback direct component references.
+template <typename... TComponents>
+class EntityView {
+ public:
+  EntityView(class Registry* registry, std::tuple<Pool<TComponents>*...> pools,
+             Signature excludedSignature);
+
+  // The callback receives (Entity, TComponents&...) or just (TComponents&...).
+  template <typename TFunction>
+  void Each(TFunction function) const;
+  // Like Each, but walks the first component's pool in its dense order,
+  // e.g. the order kept by Registry::SortComponents. With the archetype
+  // backend the order is unspecified.
+  template <typename TFunction>
+  void EachInOrder(TFunction function) const;
+
+ private:
+  template <typename TFunction>
+  void EachCandidate(const std::vector<size_t>& candidates,
+                     TFunction& function) const;
+  template <typename TComponent>
+  TComponent& GetComponent(size_t entityId) const;
 
  private:
-  void Add(T object) { data.push_back(object); }
-  void Resize(int n) { data.resize(n); }
+  class Registry* registry;
+  std::tuple<Pool<TComponents>*...> pools;
+  Signature requiredSignature;
+  Signature excludedSignature;
+};
+
+class IComponentGroup {
+ public:
+  virtual ~IComponentGroup() = default;
+  virtual const Signature& GetSignature() const = 0;
+  virtual void OnComponentAdded(size_t entityId,
+                                const Signature& entitySignature) = 0;
+  virtual void OnComponentRemoving(size_t entityId) = 0;
+  // Re-aligns the owned pools after their contents were replaced.
+  virtual void Rebuild() = 0;
+};
+
+// Owning group: keeps the first GetSize() elements of every owned pool
+// aligned on the entities that have all of TOwned, so index i of each pool
+// belongs to the same entity. Maintained by the Registry on every add and
+// remove. A pool can be owned by one group only. With the archetype backend
+// rows are already aligned and Each simply forwards to a view.
+template <typename... TOwned>
+class ComponentGroup : public IComponentGroup {
+ public:
+  ComponentGroup(class Registry* registry,
+                 std::tuple<Pool<TOwned>*...> pools);
+
+  const Signature& GetSignature() const override { return signature; }
+
+  size_t GetSize() const { return size; }
+
+  // Component at index i of the aligned range (pool backend only).
+  template <typename TComponent>
+  TComponent& Get(size_t index) const {
+    return (*std::get<Pool<TComponent>*>(pools))[index];
+  }
+
+  // The callback receives (Entity, TOwned&...) or just (TOwned&...).
+  template <typename TFunction>
+  void Each(TFunction function) const;
+
+  void OnComponentAdded(size_t entityId,
+                        const Signature& entitySignature) override;
+  void OnComponentRemoving(size_t entityId) override;
+  void Rebuild() override;
 
  private:
-  std::vector<T> data;
-  int size;
+  bool Contains(size_t entityId) const;
 
-  std::unordered_map<int, int> entityIdToIndex;
-  std::unordered_map<int, int> indexToEntityId;
+ private:
+  class Registry* registry;
+  std::tuple<Pool<TOwned>*...> pools;
+  Signature signature;
+  size_t size = 0;
 };
 
+// Where the Registry keeps component data: one Pool<T> per component type,
+// or archetype chunks grouping entities that share a Signature.
+enum class StorageBackend { Pools, Archetypes };
+
 class Registry {
  public:
-  Registry() { Logger::Log(LOG_CLASS_TAG, "Registry contructor called"); };
-  ~Registry() { Logger::Log(LOG_CLASS_TAG, "Registry destructor called"); };
+  Registry(StorageBackend storageBackend = StorageBackend::Pools);
+  ~Registry();
 
+  StorageBackend GetStorageBackend() const;
+
+  // Applies the command buffers, then adds and kills pending entities.
   void Update();
 
-  // Entity management
+  // Buffers are applied in creation order. Not thread-safe; create them up
+  // front and hand one to each thread.
+  CommandBuffer& CreateCommandBuffer();
+
+  // Memory and occupancy report: per-pool size, capacity and bytes, system
+  // entity counts, free ids, tags, groups and pending adds and kills. Walks
+  // every pool and system, so take it every few seconds, not every frame.
+  RegistryStats GetStats() const;
+
+  // Snapshots of the whole world: entities, signatures, pending adds and
+  // kills, tags, groups and every pool, in one binary blob. Trivially
+  // copyable components are copied chunk by chunk; others need a
+  // ComponentSerializer. Blobs are only valid for the same build, since
+  // pools are matched by mangled type name. Pool backend only; take and
+  // load snapshots between frames. Deserialize replaces the current world
+  // without firing signals and resets change tracking; on failure it logs
+  // and leaves the registry empty. Serializing into a reused blob keeps its
+  // capacity, which matters when snapshots are taken repeatedly.
+  std::vector<uint8_t> Serialize() const;
+  void Serialize(std::vector<uint8_t>& blob) const;
+  bool Deserialize(const std::vector<uint8_t>& blob);
+
+  // Unloads the world in O(1) per pool: every entity, component and prefab
+  // is dropped without callbacks and the arena holding the pools' chunks
+  // is freed. Systems, groups, tags, listeners and command buffers stay,
+  // so the next level can be loaded into the same registry.
+  void Clear();
+
+  // Entity management. Both abort once EntityHandle::MAX_ENTITIES ids are
+  // in use; killed ids are recycled first.
   Entity CreateEntity();
+  std::vector<Entity> CreateEntities(size_t count);
   void KillEntity(Entity entity);
+  bool IsAlive(EntityHandle handle) const;
+  Entity GetEntity(EntityHandle handle) const;
 
-  // Component management
+  // Component management. Empty component types take no pool storage, only
+  // their Signature bit, so HasComponent is a bit test and GetComponent does
+  // not compile for them. Views hand them to callbacks as a shared instance.
   template <typename TComponent, typename... TArgs>
   void AddComponent(Entity entity, TArgs&&... args);
+  // Adds components[i] to entities[i]; the vectors must be the same size.
+  // Emits onUpdate for entities that already had the component and
+  // onConstruct for the rest, as AddComponent does.
+  template <typename TComponent>
+  void AddComponents(const std::vector<Entity>& entities,
+                     std::vector<TComponent> components);
   template <typename TComponent>
   void RemoveComponent(Entity entity);
   template <typename TComponent>
   bool HasComponent(Entity entity) const;
+  // Untyped form, for code that holds only the component id.
+  bool HasComponent(Entity entity, size_t componentId) const;
+  // Hands out mutable access, so it counts as a change when tracked.
   template <typename TComponent>
   TComponent& GetComponent(Entity entity) const;
+  // Read-only access: not a change, so it neither records a tick nor marks
+  // an ordered pool unsorted, and scheduled systems may use it on types they
+  // only declare as read.
+  template <typename TComponent>
+  const TComponent& ReadComponent(Entity entity) const;
+
+  // Change tracking. Update advances the tick; tracked components record the
+  // tick of their last construction, Patch or GetComponent. Writes made
+  // through views and groups are not seen unless followed by a Patch.
+  // Tracking is off by default and costs one bit test when off. When on,
+  // GetComponent writes the tick, so scheduled systems calling it on a
+  // tracked type must declare that type as written.
+  uint32_t GetTick() const;
+  template <typename TComponent>
+  void EnableChangeTracking();
+  // True if the component was changed at or after the given tick.
+  template <typename TComponent>
+  bool WasChangedSince(Entity entity, uint32_t tick) const;
+  // Calls function(TComponent&), marks the change and fires OnUpdate.
+  template <typename TComponent, typename TFunction>
+  void Patch(Entity entity, TFunction function);
+
+  // Lifecycle signals. OnConstruct fires after a component is added,
+  // OnUpdate after it is replaced by AddComponent or patched, and OnDestroy
+  // before it is removed, including when its entity is destroyed (the
+  // entity is then already dead but its components are still readable).
+  // Listeners must not add or remove components; use a CommandBuffer.
+  template <typename TComponent>
+  ComponentSignal& OnConstruct();
+  template <typename TComponent>
+  ComponentSignal& OnUpdate();
+  template <typename TComponent>
+  ComponentSignal& OnDestroy();
+
+  // Keeps the component's pool in compare order for View::EachInOrder. The
+  // first call sorts; later calls sort again only if a component of the
+  // type was added, removed, replaced or handed out by GetComponent since,
+  // and then by insertion sort, which is cheap on nearly sorted data.
+  // Writes through views and groups are not seen. Pool backend only, and
+  // the pool must not be owned by a group.
+  template <typename TComponent, typename TCompare>
+  void SortComponents(TCompare compare);
+
+  // View management
+  template <typename... TComponents, typename... TExcluded>
+  EntityView<TComponents...> View(Exclude<TExcluded...> = Exclude<>());
+  template <typename... TOwned>
+  ComponentGroup<TOwned...>& GetComponentGroup();
 
   // System Management
   template <typename TSystem, typename... TArgs>
@@ -188,37 +772,131 @@ class Registry {
   template <typename TSystem>
   TSystem& GetSystem() const;
 
-  // Tag management
-  void TagEntity(Entity entity, const std::string& tag);
-  bool EntityHasTag(Entity entity, const std::string& tag) const;
-  Entity GetEntityByTag(const std::string& tag) const;
+  // Prefab management: a prefab is a component template kept outside the
+  // world, so views, groups and systems never see it. Instantiate copies the
+  // prefab's signature, components and group onto a new entity in one step;
+  // the given components replace or extend the prefab's. OnConstruct fires
+  // once the entity is complete, and it joins its systems at the next
+  // Update like any new entity. The prefab must exist. Prefabs are not part
+  // of snapshots.
+  PrefabId CreatePrefab();
+  template <typename TComponent, typename... TArgs>
+  void AddPrefabComponent(PrefabId prefab, TArgs&&... args);
+  void SetPrefabGroup(PrefabId prefab, GroupId group);
+  template <typename... TOverrides>
+  Entity Instantiate(PrefabId prefab, TOverrides&&... overrides);
+  // Bulk form: each component is copied to all new entities in one pass
+  // over its pool.
+  std::vector<Entity> InstantiateMany(PrefabId prefab, size_t count);
+
+  // Tag management: a tag names at most one entity, and an entity has at
+  // most one tag.
+  void TagEntity(Entity entity, TagId tag);
+  bool EntityHasTag(Entity entity, TagId tag) const;
+  Entity GetEntityByTag(TagId tag) const;
   void RemoveEntityTag(Entity entity);
 
-  // Group management
-  void GroupEntity(Entity entity, const std::string& group);
-  bool EntityBelongsToGroup(Entity entity, const std::string& group) const;
-  std::vector<Entity> GetEntitiesByGroup(const std::string& group) const;
+  // Group management: an entity belongs to at most one group.
+  void GroupEntity(Entity entity, GroupId group);
+  bool EntityBelongsToGroup(Entity entity, GroupId group) const;
+  // Calls function(Entity) for each member without copying the group.
+  template <typename TFunction>
+  void EachEntityInGroup(GroupId group, TFunction function) const;
   void RemoveEntityGroup(Entity entity);
 
  private:
-  void AddEntityToSystem(Entity entity);
-  void RemoveEntityFromSystem(Entity entity);
+  template <typename... TComponents>
+  friend class EntityView;
+  template <typename... TOwned>
+  friend class ComponentGroup;
+
+  void AddEntitiesToSystems(const std::vector<EntityHandle>& entities);
+  void DestroyEntities(const std::vector<EntityHandle>& entities);
+  // Drops every entity and component without running any callbacks.
+  void ClearEntities();
+  bool ReadSnapshot(BinaryReader& reader);
+
+  EntityHandle GetEntityHandle(size_t entityId) const;
+  [[noreturn]] void OnEntityLimitReached() const;
+
+  template <typename TComponent>
+  Pool<TComponent>* GetComponentPool() const;
+  template <typename TComponent>
+  Pool<TComponent>* GetOrCreateComponentPool();
+
+  template <typename TComponent>
+  void SetComponentData(size_t entityId, TComponent component);
+  bool IsPrefab(PrefabId prefab) const;
+  void CopyPrefabComponents(PrefabId prefab, const size_t* entityIds,
+                            size_t count);
+  void OnEntitiesInstantiated(PrefabId prefab, const Signature& signature,
+                              const Entity* entities, size_t count);
+
+  void OnComponentAdded(size_t entityId);
+  void OnComponentRemoving(size_t entityId, size_t componentId);
+  void OnSignatureChanged(size_t entityId, const Signature& oldSignature);
+  // Inline so the unwatched case is a single bit test at the call site.
+  void MarkChanged(size_t entityId, size_t componentId) const {
+    if (watchedComponents.test(componentId)) {
+      OnComponentChanged(entityId, componentId);
+    }
+  }
+  void OnComponentChanged(size_t entityId, size_t componentId) const;
 
  private:
   size_t numEntities = 0;
   std::deque<size_t> freeIds;
+  std::vector<uint32_t> entityGenerations;
+  // Declared before the pools so it outlives them.
+  PoolArena poolArena;
   std::vector<std::shared_ptr<IPool>> componentPools;
+  std::unique_ptr<ArchetypeStorage> archetypeStorage;
+  std::vector<std::unique_ptr<IComponentGroup>> componentGroups;
+  Signature groupOwnedComponents;
+
+  struct PrefabData {
+    Signature signature;
+    GroupId group = INVALID_NAME_ID;
+  };
+  std::vector<PrefabData> prefabs;
+  // Indexed by component id; the pools are keyed by PrefabId.
+  std::vector<std::shared_ptr<IPool>> prefabPools;
   std::vector<Signature> entityComponentSignatures;
+  // Entities already handed to the systems by Update; their membership is
+  // kept in sync as their signature changes.
+  std::vector<bool> entityIsActive;
   std::unordered_map<std::type_index, std::shared_ptr<System>> systems;
 
-  std::set<Entity> entitiesToBeAdded;
-  std::set<Entity> entitiesToBeKilled;
-
-  std::unordered_map<std::string, Entity> entityPerTag;
-  std::unordered_map<int, std::string> tagPerEntity;
-
-  std::unordered_map<std::string, std::set<Entity>> entitiesPerGroup;
-  std::unordered_map<int, std::string> groupPerEntity;
+  std::vector<EntityHandle> entitiesToBeAdded;
+  std::vector<EntityHandle> entitiesToBeKilled;
+  // Scratch lists reused by DestroyEntities.
+  std::vector<EntityHandle> dyingEntities;
+  std::array<std::vector<size_t>, MAX_COMPONENTS> dyingEntitiesPerComponent;
+  std::vector<std::unique_ptr<CommandBuffer>> commandBuffers;
+
+  struct ComponentSignals {
+    ComponentSignal onConstruct;
+    ComponentSignal onUpdate;
+    ComponentSignal onDestroy;
+  };
+
+  uint32_t currentTick = 1;
+  Signature trackedComponents;
+  // Components kept sorted by SortComponents, and those changed since.
+  Signature orderedComponents;
+  mutable Signature unsortedComponents;
+  // Tracked or ordered: the components MarkChanged has work for.
+  Signature watchedComponents;
+  // Indexed by component id, then entity id; 0 means never changed.
+  mutable std::array<std::vector<uint32_t>, MAX_COMPONENTS> changeTicks;
+  std::array<ComponentSignals, MAX_COMPONENTS> componentSignals;
+
+  // Indexed by TagId / GroupId and by entity id; grown on demand.
+  std::vector<EntityHandle> entityPerTag;
+  std::vector<TagId> tagPerEntity;
+
+  std::vector<SparseSet> entitiesPerGroup;
+  std::vector<GroupId> groupPerEntity;
 };
 
 template <typename TComponent, typename... TArgs>
@@ -226,6 +904,11 @@ void Entity::AddComponent(TArgs&&... args) {
   registry->AddComponent<TComponent>(*this, std::forward<TArgs>(args)...);
 }
 
+template <typename TComponent, typename TFunction>
+void Entity::Patch(TFunction function) {
+  registry->Patch<TComponent>(*this, function);
+}
+
 template <typename TComponent>
 void Entity::RemoveComponent() {
   registry->RemoveComponent<TComponent>(*this);
@@ -241,38 +924,108 @@ TComponent& Entity::GetComponent() const {
   return registry->GetComponent<TComponent>(*this);
 }
 
+template <typename TComponent>
+const TComponent& Entity::ReadComponent() const {
+  return registry->ReadComponent<TComponent>(*this);
+}
+
 template <typename TComponent>
 void System::RequireComponent() {
   const auto componentId = Component<TComponent>::GetId();
   componentSignature.set(componentId);
 }
 
+template <typename TComponent>
+void System::ReadsComponent() {
+  readSignature.set(Component<TComponent>::GetId());
+}
+
+template <typename TComponent>
+void System::WritesComponent() {
+  writeSignature.set(Component<TComponent>::GetId());
+}
+
 template <typename TComponent, typename... TArgs>
 void Registry::AddComponent(Entity entity, TArgs&&... args) {
   const auto componentId = Component<TComponent>::GetId();
   const auto entityId = entity.GetId();
 
-  if (componentId >= componentPools.size()) {
-    componentPools.resize(componentId + 1, nullptr);
+  if (archetypeStorage) {
+    archetypeStorage->Set(entityId, componentId,
+                          TComponent(std::forward<TArgs>(args)...));
+  } else if constexpr (!std::is_empty_v<TComponent>) {
+    TComponent newComponent(std::forward<TArgs>(args)...);
+    GetOrCreateComponentPool<TComponent>()->Set(entityId,
+                                                std::move(newComponent));
   }
 
-  if (!componentPools[componentId]) {
-    std::shared_ptr<Pool<TComponent>> newComponentPool =
-        std::make_shared<Pool<TComponent>>();
-    componentPools[componentId] = newComponentPool;
+  const Signature oldSignature = entityComponentSignatures[entityId];
+  entityComponentSignatures[entityId].set(componentId);
+  if (!archetypeStorage && !componentGroups.empty()) {
+    OnComponentAdded(entityId);
+  }
+  OnSignatureChanged(entityId, oldSignature);
+  MarkChanged(entityId, componentId);
+  if (oldSignature.test(componentId)) {
+    componentSignals[componentId].onUpdate.Emit(entity);
+  } else {
+    componentSignals[componentId].onConstruct.Emit(entity);
   }
 
-  std::shared_ptr<Pool<TComponent>> componentPool =
-      std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
+  Logger::Log(LOG_CLASS_TAG, "Component id " + std::to_string(componentId) +
+                                 " was added to entity id " +
+                                 std::to_string(entityId));
+}
+
+template <typename TComponent>
+void Registry::AddComponents(const std::vector<Entity>& entities,
+                             std::vector<TComponent> components) {
+  assert(entities.size() == components.size());
+  const auto componentId = Component<TComponent>::GetId();
+  const size_t count = std::min(entities.size(), components.size());
+  std::vector<bool> hadComponent(count);
+  for (size_t i = 0; i < count; i++) {
+    hadComponent[i] =
+        entityComponentSignatures[entities[i].GetId()].test(componentId);
+  }
 
-  TComponent newComponent(std::forward<TArgs>(args)...);
-  componentPool->Set(entityId, newComponent);
+  if (archetypeStorage) {
+    for (size_t i = 0; i < count; i++) {
+      archetypeStorage->Set(entities[i].GetId(), componentId,
+                            std::move(components[i]));
+    }
+  } else if constexpr (!std::is_empty_v<TComponent>) {
+    auto componentPool = GetOrCreateComponentPool<TComponent>();
+    componentPool->Reserve(componentPool->GetSize() + count);
+    for (size_t i = 0; i < count; i++) {
+      componentPool->Set(entities[i].GetId(), std::move(components[i]));
+    }
+  }
 
-  entityComponentSignatures[entityId].set(componentId);
+  for (size_t i = 0; i < count; i++) {
+    const auto entityId = entities[i].GetId();
+    const Signature oldSignature = entityComponentSignatures[entityId];
+    entityComponentSignatures[entityId].set(componentId);
+    OnSignatureChanged(entityId, oldSignature);
+  }
+  if (!archetypeStorage && !componentGroups.empty()) {
+    for (size_t i = 0; i < count; i++) {
+      OnComponentAdded(entities[i].GetId());
+    }
+  }
+  const auto& signals = componentSignals[componentId];
+  for (size_t i = 0; i < count; i++) {
+    MarkChanged(entities[i].GetId(), componentId);
+    if (hadComponent[i]) {
+      signals.onUpdate.Emit(entities[i]);
+    } else {
+      signals.onConstruct.Emit(entities[i]);
+    }
+  }
 
   Logger::Log(LOG_CLASS_TAG, "Component id " + std::to_string(componentId) +
-                                 " was added to entity id " +
-                                 std::to_string(entityId));
+                                 " was added to " + std::to_string(count) +
+                                 " entities");
 }
 
 template <typename TComponent>
@@ -280,11 +1033,32 @@ void Registry::RemoveComponent(Entity entity) {
   const auto componentId = Component<TComponent>::GetId();
   const auto entityId = entity.GetId();
 
-  std::shared_ptr<Pool<TComponent>> componentPool =
-      std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
-  componentPool[entityId]->Remove(entityId);
+  // Nothing to remove: leave signals, groups and pools alone.
+  if (entityId >= entityComponentSignatures.size() ||
+      !entityComponentSignatures[entityId].test(componentId)) {
+    return;
+  }
+  componentSignals[componentId].onDestroy.Emit(entity);
+  if (archetypeStorage) {
+    archetypeStorage->Remove(entityId, componentId);
+  } else {
+    OnComponentRemoving(entityId, componentId);
+    if constexpr (!std::is_empty_v<TComponent>) {
+      if (componentId < componentPools.size() && componentPools[componentId]) {
+        std::shared_ptr<Pool<TComponent>> componentPool =
+            std::static_pointer_cast<Pool<TComponent>>(
+                componentPools[componentId]);
+        componentPool->Remove(entityId);
+        if (orderedComponents.test(componentId)) {
+          unsortedComponents.set(componentId);
+        }
+      }
+    }
+  }
 
+  const Signature oldSignature = entityComponentSignatures[entityId];
   entityComponentSignatures[entityId].set(componentId, false);
+  OnSignatureChanged(entityId, oldSignature);
 
   Logger::Log(LOG_CLASS_TAG, "Component id " + std::to_string(componentId) +
                                  " was removed from entity id " +
@@ -300,18 +1074,380 @@ bool Registry::HasComponent(Entity entity) const {
 
 template <typename TComponent>
 TComponent& Registry::GetComponent(Entity entity) const {
+  static_assert(!std::is_empty_v<TComponent>,
+                "Empty components have no data; use HasComponent");
   const auto componentId = Component<TComponent>::GetId();
   const auto entityId = entity.GetId();
-  auto componentPool =
-      std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
-  return componentPool->Get(entityId);
+  MarkChanged(entityId, componentId);
+  if (archetypeStorage) {
+    return archetypeStorage->Get<TComponent>(entityId, componentId);
+  }
+  return GetComponentPool<TComponent>()->Get(entityId);
+}
+
+template <typename TComponent>
+const TComponent& Registry::ReadComponent(Entity entity) const {
+  static_assert(!std::is_empty_v<TComponent>,
+                "Empty components have no data; use HasComponent");
+  const auto entityId = entity.GetId();
+  if (archetypeStorage) {
+    return archetypeStorage->Get<TComponent>(entityId,
+                                             Component<TComponent>::GetId());
+  }
+  return GetComponentPool<TComponent>()->Get(entityId);
+}
+
+template <typename TComponent>
+void Registry::EnableChangeTracking() {
+  trackedComponents.set(Component<TComponent>::GetId());
+  watchedComponents.set(Component<TComponent>::GetId());
+}
+
+template <typename TComponent>
+bool Registry::WasChangedSince(Entity entity, uint32_t tick) const {
+  const auto& ticks = changeTicks[Component<TComponent>::GetId()];
+  return HasComponent<TComponent>(entity) && entity.GetId() < ticks.size() &&
+         ticks[entity.GetId()] >= tick;
+}
+
+template <typename TComponent, typename TFunction>
+void Registry::Patch(Entity entity, TFunction function) {
+  function(GetComponent<TComponent>(entity));
+  componentSignals[Component<TComponent>::GetId()].onUpdate.Emit(entity);
+}
+
+template <typename TComponent>
+ComponentSignal& Registry::OnConstruct() {
+  return componentSignals[Component<TComponent>::GetId()].onConstruct;
+}
+
+template <typename TComponent>
+ComponentSignal& Registry::OnUpdate() {
+  return componentSignals[Component<TComponent>::GetId()].onUpdate;
+}
+
+template <typename TComponent>
+ComponentSignal& Registry::OnDestroy() {
+  return componentSignals[Component<TComponent>::GetId()].onDestroy;
+}
+
+template <typename TComponent>
+Pool<TComponent>* Registry::GetComponentPool() const {
+  const auto componentId = Component<TComponent>::GetId();
+  if (componentId >= componentPools.size()) {
+    return nullptr;
+  }
+  return static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+}
+
+template <typename TComponent>
+Pool<TComponent>* Registry::GetOrCreateComponentPool() {
+  const auto componentId = Component<TComponent>::GetId();
+  if (componentId >= componentPools.size()) {
+    componentPools.resize(componentId + 1, nullptr);
+  }
+
+  if (!componentPools[componentId]) {
+    componentPools[componentId] =
+        std::make_shared<Pool<TComponent>>(100, &poolArena);
+  }
+  return static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+}
+
+template <typename TComponent, typename... TArgs>
+void Registry::AddPrefabComponent(PrefabId prefab, TArgs&&... args) {
+  if (!IsPrefab(prefab)) {
+    return;
+  }
+  const auto componentId = Component<TComponent>::GetId();
+  prefabs[prefab].signature.set(componentId);
+  // Archetype rows still hold empty components, so those are copied.
+  if (std::is_empty_v<TComponent> && !archetypeStorage) {
+    return;
+  }
+  if (componentId >= prefabPools.size()) {
+    prefabPools.resize(componentId + 1, nullptr);
+  }
+  if (!prefabPools[componentId]) {
+    prefabPools[componentId] =
+        std::make_shared<Pool<TComponent>>(1, &poolArena);
+  }
+  static_cast<Pool<TComponent>*>(prefabPools[componentId].get())
+      ->Set(prefab, TComponent(std::forward<TArgs>(args)...));
+}
+
+template <typename... TOverrides>
+Entity Registry::Instantiate(PrefabId prefab, TOverrides&&... overrides) {
+  assert(IsPrefab(prefab));
+  Entity entity = CreateEntity();
+  const size_t entityId = entity.GetId();
+  CopyPrefabComponents(prefab, &entityId, 1);
+
+  Signature signature = prefabs[prefab].signature;
+  (SetComponentData<std::decay_t<TOverrides>>(
+       entityId, std::forward<TOverrides>(overrides)),
+   ...);
+  (signature.set(Component<std::decay_t<TOverrides>>::GetId()), ...);
+  OnEntitiesInstantiated(prefab, signature, &entity, 1);
+  return entity;
+}
+
+template <typename TComponent>
+void Registry::SetComponentData(size_t entityId, TComponent component) {
+  if (archetypeStorage) {
+    archetypeStorage->Set(entityId, Component<TComponent>::GetId(),
+                          std::move(component));
+  } else if constexpr (!std::is_empty_v<TComponent>) {
+    GetOrCreateComponentPool<TComponent>()->Set(entityId,
+                                                std::move(component));
+  }
+}
+
+template <typename... TOwned>
+ComponentGroup<TOwned...>& Registry::GetComponentGroup() {
+  static_assert((!std::is_empty_v<TOwned> && ...),
+                "Empty components have no pool to own");
+  Signature signature;
+  (signature.set(Component<TOwned>::GetId()), ...);
+  for (auto& group : componentGroups) {
+    if (group->GetSignature() == signature &&
+        typeid(*group) == typeid(ComponentGroup<TOwned...>)) {
+      return static_cast<ComponentGroup<TOwned...>&>(*group);
+    }
+  }
+
+  if ((groupOwnedComponents & signature).any()) {
+    Logger::Err(LOG_CLASS_TAG,
+                "Component group overlaps a pool owned by another group");
+  }
+  if ((orderedComponents & signature).any()) {
+    Logger::Err(LOG_CLASS_TAG, "Component group owns a sorted pool");
+  }
+  groupOwnedComponents |= signature;
+
+  if (archetypeStorage) {
+    componentGroups.push_back(std::make_unique<ComponentGroup<TOwned...>>(
+        this, std::make_tuple(static_cast<Pool<TOwned>*>(nullptr)...)));
+  } else {
+    componentGroups.push_back(std::make_unique<ComponentGroup<TOwned...>>(
+        this, std::make_tuple(GetOrCreateComponentPool<TOwned>()...)));
+  }
+  return static_cast<ComponentGroup<TOwned...>&>(*componentGroups.back());
+}
+
+template <typename TComponent, typename TCompare>
+void Registry::SortComponents(TCompare compare) {
+  static_assert(!std::is_empty_v<TComponent>,
+                "Empty components have no pool to sort");
+  const auto componentId = Component<TComponent>::GetId();
+  if (!orderedComponents.test(componentId)) {
+    if (archetypeStorage || groupOwnedComponents.test(componentId)) {
+      Logger::Err(LOG_CLASS_TAG,
+                  "Component id " + std::to_string(componentId) +
+                      " can not be sorted: no pool or owned by a group");
+      return;
+    }
+    orderedComponents.set(componentId);
+    unsortedComponents.set(componentId);
+    watchedComponents.set(componentId);
+  }
+  if (!unsortedComponents.test(componentId)) {
+    return;
+  }
+  if (auto pool = GetComponentPool<TComponent>()) {
+    pool->Sort(compare);
+  }
+  unsortedComponents.reset(componentId);
+}
+
+template <typename... TComponents, typename... TExcluded>
+EntityView<TComponents...> Registry::View(Exclude<TExcluded...>) {
+  static_assert((!std::is_empty_v<TComponents> || ...),
+                "A view needs at least one component with data to walk");
+  Signature excludedSignature;
+  (excludedSignature.set(Component<TExcluded>::GetId()), ...);
+  return EntityView<TComponents...>(
+      this, std::make_tuple(GetComponentPool<TComponents>()...),
+      excludedSignature);
+}
+
+template <typename... TComponents>
+EntityView<TComponents...>::EntityView(Registry* registry,
+                                       std::tuple<Pool<TComponents>*...> pools,
+                                       Signature excludedSignature)
+    : registry(registry), pools(pools), excludedSignature(excludedSignature) {
+  (requiredSignature.set(Component<TComponents>::GetId()), ...);
+}
+
+template <typename... TComponents>
+template <typename TFunction>
+void EntityView<TComponents...>::Each(TFunction function) const {
+  if (registry->archetypeStorage) {
+    registry->archetypeStorage->template Each<TComponents...>(
+        requiredSignature, excludedSignature,
+        {Component<TComponents>::GetId()...},
+        [this, &function](size_t entityId, TComponents&... components) {
+          if constexpr (std::is_invocable_v<TFunction, Entity,
+                                            TComponents&...>) {
+            Entity entity(registry->GetEntityHandle(entityId));
+            entity.registry = registry;
+            function(entity, components...);
+          } else {
+            function(components...);
+          }
+        });
+    return;
+  }
+
+  // Empty components have no pool; their signature bits are checked per
+  // candidate.
+  const bool hasAllPools = ((std::is_empty_v<TComponents> ||
+                             std::get<Pool<TComponents>*>(pools)) &&
+                            ...);
+  if (!hasAllPools) {
+    return;
+  }
+
+  const std::vector<size_t>* candidates = nullptr;
+  auto pickSmallest = [&candidates](const auto* pool) {
+    if (pool && (!candidates || pool->GetSize() < candidates->size())) {
+      candidates = &pool->GetEntities();
+    }
+  };
+  (pickSmallest(std::get<Pool<TComponents>*>(pools)), ...);
+  EachCandidate(*candidates, function);
+}
+
+template <typename... TComponents>
+template <typename TFunction>
+void EntityView<TComponents...>::EachInOrder(TFunction function) const {
+  typedef std::tuple_element_t<0, std::tuple<TComponents...>> TFirst;
+  const bool hasAllPools = ((std::is_empty_v<TComponents> ||
+                             std::get<Pool<TComponents>*>(pools)) &&
+                            ...);
+  if (registry->archetypeStorage || !hasAllPools || std::is_empty_v<TFirst>) {
+    Each(function);
+    return;
+  }
+  EachCandidate(std::get<0>(pools)->GetEntities(), function);
+}
+
+template <typename... TComponents>
+template <typename TFunction>
+void EntityView<TComponents...>::EachCandidate(
+    const std::vector<size_t>& candidates, TFunction& function) const {
+  // Walk by index: the callback may add components and grow the pool being
+  // iterated.
+  for (size_t i = 0; i < candidates.size(); i++) {
+    const size_t entityId = candidates[i];
+    const Signature& signature = registry->entityComponentSignatures[entityId];
+    if ((signature & requiredSignature) != requiredSignature ||
+        (signature & excludedSignature).any()) {
+      continue;
+    }
+    if constexpr (std::is_invocable_v<TFunction, Entity, TComponents&...>) {
+      Entity entity(registry->GetEntityHandle(entityId));
+      entity.registry = registry;
+      function(entity, GetComponent<TComponents>(entityId)...);
+    } else {
+      function(GetComponent<TComponents>(entityId)...);
+    }
+  }
+}
+
+template <typename... TComponents>
+template <typename TComponent>
+TComponent& EntityView<TComponents...>::GetComponent(size_t entityId) const {
+  if constexpr (std::is_empty_v<TComponent>) {
+    // Stateless, so every entity can share one instance.
+    static TComponent instance;
+    return instance;
+  } else {
+    return std::get<Pool<TComponent>*>(pools)->Get(entityId);
+  }
+}
+
+template <typename... TOwned>
+ComponentGroup<TOwned...>::ComponentGroup(Registry* registry,
+                                          std::tuple<Pool<TOwned>*...> pools)
+    : registry(registry), pools(pools) {
+  (signature.set(Component<TOwned>::GetId()), ...);
+  Rebuild();
+}
+
+template <typename... TOwned>
+void ComponentGroup<TOwned...>::Rebuild() {
+  size = 0;
+  if (registry->archetypeStorage) {
+    return;
+  }
+
+  // Pull the entities that already own every component to the front.
+  const auto& candidates = std::get<0>(pools)->GetEntities();
+  for (size_t i = 0; i < candidates.size(); i++) {
+    const size_t entityId = candidates[i];
+    OnComponentAdded(entityId, registry->entityComponentSignatures[entityId]);
+  }
+}
+
+template <typename... TOwned>
+template <typename TFunction>
+void ComponentGroup<TOwned...>::Each(TFunction function) const {
+  if (registry->archetypeStorage) {
+    registry->View<TOwned...>().Each(function);
+    return;
+  }
+
+  const auto& entityIds = std::get<0>(pools)->GetEntities();
+  for (size_t i = 0; i < size; i++) {
+    if constexpr (std::is_invocable_v<TFunction, Entity, TOwned&...>) {
+      Entity entity(registry->GetEntityHandle(entityIds[i]));
+      entity.registry = registry;
+      function(entity, (*std::get<Pool<TOwned>*>(pools))[i]...);
+    } else {
+      function((*std::get<Pool<TOwned>*>(pools))[i]...);
+    }
+  }
+}
+
+template <typename... TOwned>
+void ComponentGroup<TOwned...>::OnComponentAdded(
+    size_t entityId, const Signature& entitySignature) {
+  if ((entitySignature & signature) != signature || Contains(entityId)) {
+    return;
+  }
+  (std::get<Pool<TOwned>*>(pools)->Swap(
+       std::get<Pool<TOwned>*>(pools)->IndexOf(entityId), size),
+   ...);
+  size++;
+}
+
+template <typename... TOwned>
+void ComponentGroup<TOwned...>::OnComponentRemoving(size_t entityId) {
+  if (!Contains(entityId)) {
+    return;
+  }
+  size--;
+  (std::get<Pool<TOwned>*>(pools)->Swap(
+       std::get<Pool<TOwned>*>(pools)->IndexOf(entityId), size),
+   ...);
+}
+
+template <typename... TOwned>
+bool ComponentGroup<TOwned...>::Contains(size_t entityId) const {
+  const auto* pool = std::get<0>(pools);
+  return pool->Contains(entityId) && pool->IndexOf(entityId) < size;
 }
 
 template <typename TSystem, typename... TArgs>
 void Registry::AddSystem(TArgs&&... args) {
   std::shared_ptr<TSystem> newSystem =
       std::make_shared<TSystem>(std::forward<TArgs>(args)...);
+  newSystem->registry = this;
+  newSystem->commandBuffer = &CreateCommandBuffer();
   systems.insert(std::make_pair(std::type_index(typeid(TSystem)), newSystem));
+  // Through the base, where Registry is a friend.
+  static_cast<System&>(*newSystem).OnAdded();
 }
 
 template <typename TSystem>
@@ -330,3 +1466,13 @@ TSystem& Registry::GetSystem() const {
   auto system = systems.find(std::type_index(typeid(TSystem)));
   return *(std::static_pointer_cast<TSystem>(system->second));
 }
+
+template <typename TFunction>
+void Registry::EachEntityInGroup(GroupId group, TFunction function) const {
+  if (group >= entitiesPerGroup.size()) {
+    return;
+  }
+  for (auto entityId : entitiesPerGroup[group].GetEntities()) {
+    function(GetEntity(GetEntityHandle(entityId)));
+  }
+}
@@ -0,0 +1,48 @@
+#include "PoolArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+size_t AlignUp(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+void* PoolArena::Allocate(size_t size, size_t alignment) {
+  for (; currentBlock < blocks.size(); currentBlock++) {
+    Block& block = blocks[currentBlock];
+    const uintptr_t base = reinterpret_cast<uintptr_t>(block.bytes.get());
+    const size_t offset = AlignUp(base + block.used, alignment) - base;
+    if (offset + size <= block.size) {
+      block.used = offset + size;
+      return block.bytes.get() + offset;
+    }
+  }
+
+  // Oversized requests get a block of their own.
+  Block block;
+  block.size = std::max(BLOCK_SIZE, size + alignment);
+  block.bytes.reset(new unsigned char[block.size]);
+  const uintptr_t base = reinterpret_cast<uintptr_t>(block.bytes.get());
+  const size_t offset = AlignUp(base, alignment) - base;
+  block.used = offset + size;
+  allocationCount++;
+  bytesReserved += block.size;
+  blocks.push_back(std::move(block));
+  currentBlock = blocks.size() - 1;
+  return blocks.back().bytes.get() + offset;
+}
+
+void PoolArena::Release() {
+  blocks.clear();
+  currentBlock = 0;
+  bytesReserved = 0;
+}
+
+void PoolArena::Reset() {
+  for (auto& block : blocks) {
+    block.used = 0;
+  }
+  currentBlock = 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator handing out component chunks. Memory is only returned all
+// at once, when the arena is released or destroyed, so tearing down a world
+// costs one free per block rather than one per component chunk.
+class PoolArena {
+ public:
+  static constexpr size_t BLOCK_SIZE = 256 * 1024;
+
+  PoolArena() = default;
+  PoolArena(const PoolArena&) = delete;
+  PoolArena& operator=(const PoolArena&) = delete;
+
+  void* Allocate(size_t size, size_t alignment);
+
+  // Frees every block. Anything allocated from the arena becomes invalid.
+  void Release();
+
+  // Like Release, but keeps the blocks to serve later allocations.
+  void Reset();
+
+  // Number of blocks requested from the heap since construction.
+  size_t GetAllocationCount() const { return allocationCount; }
+
+  size_t GetBytesReserved() const { return bytesReserved; }
+
+ private:
+  struct Block {
+    std::unique_ptr<unsigned char[]> bytes;
+    size_t size = 0;
+    size_t used = 0;
+  };
+
+ private:
+  std::vector<Block> blocks;
+  size_t currentBlock = 0;
+  size_t allocationCount = 0;
+  size_t bytesReserved = 0;
+};
@@ -0,0 +1,53 @@
+#include "RegistryStats.h"
+
+size_t RegistryStats::GetPoolBytesUsed() const {
+  size_t bytes = 0;
+  for (const auto& pool : pools) {
+    bytes += pool.bytesUsed;
+  }
+  return bytes;
+}
+
+size_t RegistryStats::GetPoolBytesWasted() const {
+  size_t bytes = 0;
+  for (const auto& pool : pools) {
+    bytes += pool.bytesWasted;
+  }
+  return bytes;
+}
+
+std::vector<std::string> RegistryStats::Format() const {
+  std::vector<std::string> lines;
+  lines.push_back(
+      "tick " + std::to_string(tick) + ": " + std::to_string(numEntities) +
+      " entity ids, " + std::to_string(numFreeIds) + " free, " +
+      std::to_string(numPendingAdds) + " pending adds, " +
+      std::to_string(numPendingKills) + " pending kills, " +
+      std::to_string(numTags) + "/" + std::to_string(tagTableSize) +
+      " tags, " + std::to_string(numGroupMembers) + " group members in " +
+      std::to_string(groupTableSize) + " groups, " +
+      std::to_string(numPrefabs) + " prefabs, arena " +
+      std::to_string(arenaBytesReserved) + " bytes in " +
+      std::to_string(arenaBlockCount) + " blocks, pools " +
+      std::to_string(GetPoolBytesUsed()) + " bytes used, " +
+      std::to_string(GetPoolBytesWasted()) + " wasted");
+  for (const auto& pool : pools) {
+    lines.push_back("pool " + pool.componentName + ": " +
+                    std::to_string(pool.size) + "/" +
+                    std::to_string(pool.capacity) + " slots, " +
+                    std::to_string(pool.bytesUsed) + " bytes used, " +
+                    std::to_string(pool.bytesWasted) + " wasted, " +
+                    std::to_string(pool.indexBytes) + " index");
+  }
+  for (const auto& system : systems) {
+    lines.push_back("system " + system.systemName + ": " +
+                    std::to_string(system.numEntities) + " entities");
+  }
+  return lines;
+}
+
+void RegistryStats::Write(std::ostream& stream) const {
+  for (const auto& line : Format()) {
+    stream << line << '\n';
+  }
+}
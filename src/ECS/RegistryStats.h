@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Occupancy of one component pool. Capacity counts the slots of every chunk
+// the pool has taken from the arena; chunks are never given back, so a pool
+// whose capacity stays far above its size after a burst of spawns shows up
+// as wasted bytes. indexBytes is the entity id index kept next to the data.
+struct PoolStats {
+  std::string componentName;
+  size_t size = 0;
+  size_t capacity = 0;
+  size_t bytesUsed = 0;
+  size_t bytesWasted = 0;
+  size_t indexBytes = 0;
+};
+
+struct SystemStats {
+  std::string systemName;
+  size_t numEntities = 0;
+};
+
+// Point-in-time view of a Registry's memory and bookkeeping, taken with
+// Registry::GetStats. Pools are listed by component id; only the pool
+// backend has any.
+struct RegistryStats {
+  uint32_t tick = 0;
+  // Ids ever handed out, and how many of them wait in the free list.
+  size_t numEntities = 0;
+  size_t numFreeIds = 0;
+  size_t numPendingAdds = 0;
+  size_t numPendingKills = 0;
+  // Tags and groups in use, and the size of the tables indexed by them.
+  size_t numTags = 0;
+  size_t tagTableSize = 0;
+  size_t numGroupMembers = 0;
+  size_t groupTableSize = 0;
+  size_t numPrefabs = 0;
+  size_t arenaBytesReserved = 0;
+  size_t arenaBlockCount = 0;
+  std::vector<PoolStats> pools;
+  std::vector<SystemStats> systems;
+
+  size_t GetPoolBytesUsed() const;
+  size_t GetPoolBytesWasted() const;
+
+  // A summary line followed by one line per pool and per system, suitable
+  // for Logger::Log or a stats file.
+  std::vector<std::string> Format() const;
+  void Write(std::ostream& stream) const;
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Appends raw little-endian-as-host bytes to a blob. Snapshots are meant to
+// be read back by the same build on the same machine.
+class BinaryWriter {
+ public:
+  explicit BinaryWriter(std::vector<uint8_t>& blob) : blob(blob) {}
+
+  void WriteBytes(const void* bytes, size_t size) {
+    const auto* first = static_cast<const uint8_t*>(bytes);
+    blob.insert(blob.end(), first, first + size);
+  }
+
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Use a serializer");
+    static_assert(!std::is_same_v<T, bool>, "Use WriteBool");
+    WriteBytes(&value, sizeof(T));
+  }
+
+  void WriteBool(bool value) { Write(static_cast<uint8_t>(value)); }
+
+  void WriteString(const std::string& value) {
+    Write(static_cast<uint32_t>(value.size()));
+    WriteBytes(value.data(), value.size());
+  }
+
+ private:
+  std::vector<uint8_t>& blob;
+};
+
+// Reads what BinaryWriter wrote. Reading past the end sets the failure flag
+// and leaves the destination untouched, so callers can check once at the end.
+class BinaryReader {
+ public:
+  BinaryReader(const uint8_t* bytes, size_t size)
+      : position(bytes), end(bytes + size) {}
+
+  bool HasFailed() const { return hasFailed; }
+
+  size_t GetRemaining() const { return end - position; }
+
+  bool ReadBytes(void* bytes, size_t size) {
+    if (hasFailed || static_cast<size_t>(end - position) < size) {
+      hasFailed = true;
+      return false;
+    }
+    if (size > 0) {
+      std::memcpy(bytes, position, size);
+      position += size;
+    }
+    return true;
+  }
+
+  template <typename T>
+  bool Read(T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Use a serializer");
+    static_assert(!std::is_same_v<T, bool>, "Use ReadBool");
+    return ReadBytes(&value, sizeof(T));
+  }
+
+  // Only 0 and 1 are bools; anything else fails the read.
+  bool ReadBool(bool& value) {
+    uint8_t byte = 0;
+    if (!Read(byte)) {
+      return false;
+    }
+    if (byte > 1) {
+      hasFailed = true;
+      return false;
+    }
+    value = byte == 1;
+    return true;
+  }
+
+  bool ReadString(std::string& value) {
+    uint32_t size = 0;
+    if (!Read(size) || static_cast<size_t>(end - position) < size) {
+      hasFailed = true;
+      return false;
+    }
+    value.assign(reinterpret_cast<const char*>(position), size);
+    position += size;
+    return true;
+  }
+
+ private:
+  const uint8_t* position;
+  const uint8_t* end;
+  bool hasFailed = false;
+};
+
+// How a component type is written to a snapshot. Trivially copyable types
+// without a specialization are copied in bulk by their pool, so their bytes
+// are trusted as they are; types with bool or enum members, whose bytes can
+// be invalid, and types that are not trivially copyable need a
+// specialization next to their definition providing Write and Read, e.g.
+//   template <>
+//   struct ComponentSerializer<SpriteComponent> {
+//     static constexpr bool isSupported = true;
+//     static void Write(BinaryWriter& writer, const SpriteComponent& sprite);
+//     static void Read(BinaryReader& reader, SpriteComponent& sprite);
+//   };
+template <typename T>
+struct ComponentSerializer {
+  static constexpr bool isSupported = std::is_trivially_copyable_v<T>;
+};
+
+// Whether a pool copies T's bytes in bulk instead of calling the
+// serializer, i.e. T is trivially copyable and has no specialization.
+template <typename T, typename = void>
+struct IsBulkSerialized : std::is_trivially_copyable<T> {};
+
+template <typename T>
+struct IsBulkSerialized<T, std::void_t<decltype(&ComponentSerializer<T>::Read)>>
+    : std::false_type {};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <bitset>
+
+const size_t MAX_COMPONENTS = 32;
+typedef std::bitset<MAX_COMPONENTS> Signature;
+
+// Calls function(componentId) for every bit set in the signature, in
+// increasing order, skipping the clear bits.
+template <typename TFunction>
+void ForEachComponentId(const Signature& signature, TFunction function) {
+  unsigned long bits = signature.to_ulong();
+  while (bits) {
+    function(static_cast<size_t>(__builtin_ctzl(bits)));
+    bits &= bits - 1;
+  }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Maps entity ids to packed dense indices. The sparse side is split into
+// fixed-size pages that are only allocated when an id inside them is used,
+// so a few large ids do not force one huge allocation.
+class SparseSet {
+ public:
+  static constexpr size_t PAGE_SIZE = 4096;
+  static constexpr uint32_t INVALID_INDEX =
+      std::numeric_limits<uint32_t>::max();
+
+  bool IsEmpty() const { return dense.empty(); }
+
+  size_t GetSize() const { return dense.size(); }
+
+  void Reserve(size_t capacity) { dense.reserve(capacity); }
+
+  bool Contains(size_t entityId) const {
+    const size_t page = entityId / PAGE_SIZE;
+    return page < sparse.size() && sparse[page] &&
+           (*sparse[page])[entityId % PAGE_SIZE] != INVALID_INDEX;
+  }
+
+  // Unchecked: the entity must be in the set.
+  size_t IndexOf(size_t entityId) const {
+    return (*sparse[entityId / PAGE_SIZE])[entityId % PAGE_SIZE];
+  }
+
+  // Appends the entity to the dense array and returns its index. The entity
+  // must not already be in the set.
+  size_t Insert(size_t entityId) {
+    const size_t index = dense.size();
+    SparseSlot(entityId) = static_cast<uint32_t>(index);
+    dense.push_back(entityId);
+    return index;
+  }
+
+  // Moves the last dense element into the hole left by the removed entity
+  // and returns the index of that hole. The entity must be in the set.
+  size_t Remove(size_t entityId) {
+    const size_t index = IndexOf(entityId);
+    const size_t last = dense.back();
+    dense[index] = last;
+    (*sparse[last / PAGE_SIZE])[last % PAGE_SIZE] =
+        static_cast<uint32_t>(index);
+    (*sparse[entityId / PAGE_SIZE])[entityId % PAGE_SIZE] = INVALID_INDEX;
+    dense.pop_back();
+    return index;
+  }
+
+  // Exchanges the dense positions of the entities at the two indices.
+  void Swap(size_t indexA, size_t indexB) {
+    const size_t entityA = dense[indexA];
+    const size_t entityB = dense[indexB];
+    dense[indexA] = entityB;
+    dense[indexB] = entityA;
+    (*sparse[entityA / PAGE_SIZE])[entityA % PAGE_SIZE] =
+        static_cast<uint32_t>(indexB);
+    (*sparse[entityB / PAGE_SIZE])[entityB % PAGE_SIZE] =
+        static_cast<uint32_t>(indexA);
+  }
+
+  void Clear() {
+    for (auto entityId : dense) {
+      (*sparse[entityId / PAGE_SIZE])[entityId % PAGE_SIZE] = INVALID_INDEX;
+    }
+    dense.clear();
+  }
+
+  const std::vector<size_t>& GetEntities() const { return dense; }
+
+  // Heap memory held by the sparse pages and the dense array.
+  size_t GetBytesReserved() const {
+    size_t bytes = sparse.capacity() * sizeof(std::unique_ptr<Page>) +
+                   dense.capacity() * sizeof(size_t);
+    for (const auto& page : sparse) {
+      if (page) {
+        bytes += sizeof(Page);
+      }
+    }
+    return bytes;
+  }
+
+ private:
+  typedef std::array<uint32_t, PAGE_SIZE> Page;
+
+  uint32_t& SparseSlot(size_t entityId) {
+    const size_t page = entityId / PAGE_SIZE;
+    if (page >= sparse.size()) {
+      sparse.resize(page + 1);
+    }
+    if (!sparse[page]) {
+      sparse[page] = std::make_unique<Page>();
+      sparse[page]->fill(INVALID_INDEX);
+    }
+    return (*sparse[page])[entityId % PAGE_SIZE];
+  }
+
+ private:
+  std::vector<std::unique_ptr<Page>> sparse;
+  std::vector<size_t> dense;
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "ECS.h"
+
+template <typename... TTypes>
+struct TypeList {
+  static constexpr size_t size = sizeof...(TTypes);
+};
+
+// Position of T in a TypeList; naming a type that is not in the list fails
+// to compile.
+template <typename T, typename TList>
+struct TypeIndex;
+
+template <typename T, typename... TRest>
+struct TypeIndex<T, TypeList<T, TRest...>>
+    : std::integral_constant<size_t, 0> {};
+
+template <typename T, typename THead, typename... TRest>
+struct TypeIndex<T, TypeList<THead, TRest...>>
+    : std::integral_constant<size_t,
+                             1 + TypeIndex<T, TypeList<TRest...>>::value> {};
+
+template <typename TComponentList, typename TSystemList>
+class StaticRegistry;
+
+// Opt-in alternative to Registry for worlds whose component and system types
+// are known up front, e.g.
+//   StaticRegistry<TypeList<TransformComponent, RigidBodyComponent>,
+//                  TypeList<MySystem>> registry;
+// Component ids are constexpr, pools live by value in a tuple (no IPool
+// virtuals, no shared_ptr casts) and GetSystem is a std::get. Systems are
+// plain default-constructible classes that query the registry with Each
+// instead of keeping entity lists.
+template <typename... TComponents, typename... TSystems>
+class StaticRegistry<TypeList<TComponents...>, TypeList<TSystems...>> {
+  static_assert(sizeof...(TComponents) <= MAX_COMPONENTS,
+                "Too many component types for Signature");
+
+ public:
+  template <typename TComponent>
+  static constexpr size_t GetComponentId() {
+    return TypeIndex<TComponent, TypeList<TComponents...>>::value;
+  }
+
+  // Bumping the generation before recycling turns duplicate kills into
+  // stale handles, so each id is freed once.
+  void Update() {
+    for (auto handle : entitiesToBeKilled) {
+      if (!IsAlive(handle)) {
+        continue;
+      }
+      const auto entityId = handle.GetIndex();
+      entityGenerations[entityId] =
+          (entityGenerations[entityId] + 1) & EntityHandle::GENERATION_MASK;
+      const Signature signature = entityComponentSignatures[entityId];
+      (RemoveIfPresent<TComponents>(entityId, signature), ...);
+      entityComponentSignatures[entityId].reset();
+      freeIds.push_back(entityId);
+    }
+    entitiesToBeKilled.clear();
+  }
+
+  // Entity management
+  EntityHandle CreateEntity() {
+    uint32_t entityId = 0;
+    if (freeIds.empty()) {
+      entityId = static_cast<uint32_t>(entityGenerations.size());
+      entityGenerations.push_back(0);
+      entityComponentSignatures.emplace_back();
+    } else {
+      entityId = freeIds.front();
+      freeIds.pop_front();
+    }
+    return EntityHandle(entityId, entityGenerations[entityId]);
+  }
+
+  void KillEntity(EntityHandle handle) {
+    if (IsAlive(handle)) {
+      entitiesToBeKilled.push_back(handle);
+    }
+  }
+
+  bool IsAlive(EntityHandle handle) const {
+    return handle.GetIndex() < entityGenerations.size() &&
+           entityGenerations[handle.GetIndex()] == handle.GetGeneration();
+  }
+
+  // Component management. The handle must be alive: a stale one would
+  // reach the component of its slot's new owner.
+  template <typename TComponent, typename... TArgs>
+  void AddComponent(EntityHandle handle, TArgs&&... args) {
+    assert(IsAlive(handle));
+    GetPool<TComponent>().Set(handle.GetIndex(),
+                              TComponent(std::forward<TArgs>(args)...));
+    entityComponentSignatures[handle.GetIndex()].set(
+        GetComponentId<TComponent>());
+  }
+
+  template <typename TComponent>
+  void RemoveComponent(EntityHandle handle) {
+    if (HasComponent<TComponent>(handle)) {
+      GetPool<TComponent>().Remove(handle.GetIndex());
+      entityComponentSignatures[handle.GetIndex()].reset(
+          GetComponentId<TComponent>());
+    }
+  }
+
+  template <typename TComponent>
+  bool HasComponent(EntityHandle handle) const {
+    assert(IsAlive(handle));
+    return entityComponentSignatures[handle.GetIndex()].test(
+        GetComponentId<TComponent>());
+  }
+
+  template <typename TComponent>
+  TComponent& GetComponent(EntityHandle handle) {
+    assert(IsAlive(handle));
+    return GetPool<TComponent>().Get(handle.GetIndex());
+  }
+
+  // Same contract as EntityView::Each, with the callback receiving an
+  // EntityHandle instead of an Entity.
+  template <typename... TViewed, typename TFunction, typename... TExcluded>
+  void Each(TFunction function, Exclude<TExcluded...> = Exclude<>()) {
+    Signature requiredSignature;
+    (requiredSignature.set(GetComponentId<TViewed>()), ...);
+    Signature excludedSignature;
+    (excludedSignature.set(GetComponentId<TExcluded>()), ...);
+
+    const std::vector<size_t>* candidates = nullptr;
+    auto pickSmallest = [&candidates](const auto& pool) {
+      if (!candidates || pool.GetSize() < candidates->size()) {
+        candidates = &pool.GetEntities();
+      }
+    };
+    (pickSmallest(GetPool<TViewed>()), ...);
+
+    for (size_t i = 0; i < candidates->size(); i++) {
+      const size_t entityId = (*candidates)[i];
+      const Signature& signature = entityComponentSignatures[entityId];
+      if ((signature & requiredSignature) != requiredSignature ||
+          (signature & excludedSignature).any()) {
+        continue;
+      }
+      if constexpr (std::is_invocable_v<TFunction, EntityHandle,
+                                        TViewed&...>) {
+        function(EntityHandle(entityId, entityGenerations[entityId]),
+                 GetPool<TViewed>().Get(entityId)...);
+      } else {
+        function(GetPool<TViewed>().Get(entityId)...);
+      }
+    }
+  }
+
+  // System management
+  template <typename TSystem>
+  TSystem& GetSystem() {
+    return std::get<TSystem>(systems);
+  }
+
+ private:
+  template <typename TComponent>
+  Pool<TComponent>& GetPool() {
+    return std::get<GetComponentId<TComponent>()>(pools);
+  }
+
+  template <typename TComponent>
+  const Pool<TComponent>& GetPool() const {
+    return std::get<GetComponentId<TComponent>()>(pools);
+  }
+
+  template <typename TComponent>
+  void RemoveIfPresent(size_t entityId, const Signature& signature) {
+    if (signature.test(GetComponentId<TComponent>())) {
+      GetPool<TComponent>().Remove(entityId);
+    }
+  }
+
+ private:
+  std::tuple<Pool<TComponents>...> pools;
+  std::tuple<TSystems...> systems;
+
+  std::vector<Signature> entityComponentSignatures;
+  std::vector<uint32_t> entityGenerations;
+  std::deque<uint32_t> freeIds;
+  std::vector<EntityHandle> entitiesToBeKilled;
+};
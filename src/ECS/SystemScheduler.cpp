@@ -0,0 +1,112 @@
+#include "SystemScheduler.h"
+
+#include <algorithm>
+
+SystemScheduler::SystemScheduler(size_t numWorkers) {
+  for (size_t i = 0; i < numWorkers; i++) {
+    workers.emplace_back(&SystemScheduler::WorkerLoop, this);
+  }
+}
+
+SystemScheduler::~SystemScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    isStopping = true;
+  }
+  wakeup.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+size_t SystemScheduler::DefaultWorkerCount() {
+  // The calling thread runs steps too.
+  const size_t hardwareThreads = std::thread::hardware_concurrency();
+  return std::min<size_t>(hardwareThreads > 1 ? hardwareThreads - 1 : 0, 3);
+}
+
+void SystemScheduler::SetSingleThreaded(bool isSingleThreaded) {
+  this->isSingleThreaded = isSingleThreaded;
+}
+
+void SystemScheduler::AddStep(const System& system,
+                              std::function<void()> update) {
+  steps.push_back({&system, std::move(update)});
+}
+
+bool SystemScheduler::Conflicts(const System& a, const System& b) {
+  if (a.IsExclusive() || b.IsExclusive()) {
+    return true;
+  }
+  const Signature aAccess = a.GetReadSignature() | a.GetWriteSignature();
+  const Signature bAccess = b.GetReadSignature() | b.GetWriteSignature();
+  return (a.GetWriteSignature() & bAccess).any() ||
+         (b.GetWriteSignature() & aAccess).any();
+}
+
+void SystemScheduler::Run() {
+  if (isSingleThreaded || workers.empty()) {
+    for (auto& step : steps) {
+      step.update();
+    }
+    steps.clear();
+    return;
+  }
+
+  const size_t numSteps = steps.size();
+  successors.assign(numSteps, {});
+  pendingPredecessors.assign(numSteps, 0);
+  for (size_t later = 0; later < numSteps; later++) {
+    for (size_t earlier = 0; earlier < later; earlier++) {
+      if (Conflicts(*steps[earlier].system, *steps[later].system)) {
+        successors[earlier].push_back(later);
+        pendingPredecessors[later]++;
+      }
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  completedSteps = 0;
+  for (size_t step = 0; step < numSteps; step++) {
+    if (pendingPredecessors[step] == 0) {
+      readySteps.push_back(step);
+    }
+  }
+  wakeup.notify_all();
+
+  while (completedSteps < numSteps) {
+    if (readySteps.empty()) {
+      wakeup.wait(lock);
+    } else {
+      RunReadyStep(lock);
+    }
+  }
+  steps.clear();
+}
+
+void SystemScheduler::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    wakeup.wait(lock, [this] { return isStopping || !readySteps.empty(); });
+    if (isStopping) {
+      return;
+    }
+    RunReadyStep(lock);
+  }
+}
+
+void SystemScheduler::RunReadyStep(std::unique_lock<std::mutex>& lock) {
+  const size_t step = readySteps.front();
+  readySteps.pop_front();
+  lock.unlock();
+  steps[step].update();
+  lock.lock();
+
+  completedSteps++;
+  for (auto next : successors[step]) {
+    if (--pendingPredecessors[next] == 0) {
+      readySteps.push_back(next);
+    }
+  }
+  wakeup.notify_all();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ECS.h"
+
+// Runs one frame of system updates on a small thread pool. Steps are added
+// in the serial order the game expects; Run links every step to the earlier
+// steps whose declared component access conflicts with it and executes the
+// resulting DAG, so systems that touch disjoint components run concurrently
+// and the results match the serial order.
+class SystemScheduler {
+ public:
+  // With zero worker threads every step runs on the calling thread.
+  explicit SystemScheduler(size_t numWorkers = DefaultWorkerCount());
+  ~SystemScheduler();
+
+  SystemScheduler(const SystemScheduler&) = delete;
+  SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+  static size_t DefaultWorkerCount();
+
+  // Runs the steps one after another in the order they were added. Useful
+  // for debugging ordering problems.
+  void SetSingleThreaded(bool isSingleThreaded);
+
+  // Queues the update of a system for the next Run.
+  void AddStep(const System& system, std::function<void()> update);
+
+  // Executes and clears the queued steps, returning once all have finished.
+  void Run();
+
+ private:
+  struct Step {
+    const System* system;
+    std::function<void()> update;
+  };
+
+  static bool Conflicts(const System& a, const System& b);
+
+  void WorkerLoop();
+  void RunReadyStep(std::unique_lock<std::mutex>& lock);
+
+ private:
+  std::vector<std::thread> workers;
+  bool isSingleThreaded = false;
+
+  std::vector<Step> steps;
+  std::vector<std::vector<size_t>> successors;
+  std::vector<size_t> pendingPredecessors;
+
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  std::deque<size_t> readySteps;
+  size_t completedSteps = 0;
+  bool isStopping = false;
+};
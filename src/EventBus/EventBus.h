@@ -1,74 +1,597 @@
 #pragma once
 
-#include <functional>
-#include <list>
-#include <map>
-#include <typeindex>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
 
+#include "../ECS/Serialization.h"
 #include "../Logger/Logger.h"
 #include "Event.h"
+#include "EventTrace.h"
 
-class IEventCallback {
+// A batch of queued events handed to batch handlers in one call.
+template <typename TEvent>
+class EventSpan {
  public:
-  virtual ~IEventCallback() = default;
-  void Execute(Event& e) { Call(e); }
+  EventSpan(TEvent* events, size_t size) : events(events), size(size) {}
+
+  TEvent* begin() const { return events; }
+  TEvent* end() const { return events + size; }
+  size_t GetSize() const { return size; }
+  bool IsEmpty() const { return size == 0; }
+  TEvent& operator[](size_t index) const { return events[index]; }
 
  private:
-  virtual void Call(Event& e) = 0;
+  TEvent* events;
+  size_t size;
 };
 
-template <typename TOwner, typename TEvent>
-class EventCallback : public IEventCallback {
-  typedef void (TOwner::*CallbackFunction)(TEvent&);
-
+// A member function bound to its owner, stored by value: the member
+// function pointer is copied into the delegate and called through a plain
+// function pointer instantiated for the owner's type, so handlers sit in a
+// contiguous vector with no allocation or virtual call per handler.
+template <typename TArgument>
+class EventDelegate {
  public:
-  EventCallback(TOwner* ownerInstance, CallbackFunction callbackFunction) {
-    this->ownerInstance = ownerInstance;
-    this->callbackFunction = callbackFunction;
+  template <typename TOwner>
+  EventDelegate(uint32_t id, TOwner* owner,
+                void (TOwner::*function)(TArgument))
+      : id(id),
+        owner(owner),
+        ownerName(typeid(TOwner).name()),
+        invoke(&Invoke<TOwner>) {
+    static_assert(sizeof(function) <= sizeof(functionBytes),
+                  "Member function pointer too large for EventDelegate");
+    std::memcpy(functionBytes, &function, sizeof(function));
   }
 
+  uint32_t GetId() const { return id; }
+  const char* GetOwnerName() const { return ownerName; }
+
+  // Disabled delegates wait to be erased after the current dispatch.
+  bool IsEnabled() const { return invoke != nullptr; }
+  void Disable() { invoke = nullptr; }
+
+  void operator()(TArgument argument) const { invoke(*this, argument); }
+
+  // Calls and time spent in them since the last CollectTrace, counted only
+  // while the bus is tracing.
+  size_t numCalls = 0;
+  std::chrono::steady_clock::duration callTime{};
+
  private:
-  virtual void Call(Event& e) override {
-    std::invoke(callbackFunction, ownerInstance, static_cast<TEvent&>(e));
+  template <typename TOwner>
+  static void Invoke(const EventDelegate& delegate, TArgument argument) {
+    void (TOwner::*function)(TArgument);
+    std::memcpy(&function, delegate.functionBytes, sizeof(function));
+    (static_cast<TOwner*>(delegate.owner)->*function)(argument);
   }
 
  private:
-  TOwner* ownerInstance;
-  CallbackFunction callbackFunction;
+  uint32_t id;
+  void* owner;
+  const char* ownerName;
+  void (*invoke)(const EventDelegate&, TArgument);
+  alignas(void*) unsigned char functionBytes[2 * sizeof(void*)];
+};
+
+// Returned by the Subscribe functions and passed to Unsubscribe. A default
+// constructed handle refers to no subscription.
+class SubscriptionHandle {
+ public:
+  SubscriptionHandle() = default;
+  SubscriptionHandle(uint32_t eventTypeId, uint32_t id)
+      : eventTypeId(eventTypeId), id(id) {}
+
+  bool IsValid() const { return id != 0; }
+  uint32_t GetEventTypeId() const { return eventTypeId; }
+  uint32_t GetId() const { return id; }
+
+ private:
+  uint32_t eventTypeId = 0;
+  uint32_t id = 0;
+};
+
+// Event type ids are handed out on first use, like component ids, and index
+// the bus's flat array of channels, so no emission looks up a map.
+class IEventType {
+ protected:
+  static inline std::atomic<size_t> nextId{0};
+};
+
+template <typename TEvent>
+class EventType : public IEventType {
+ public:
+  static size_t GetId() {
+    static const size_t id = nextId++;
+    return id;
+  }
 };
 
-typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
+class IEventBuffer {
+ public:
+  virtual ~IEventBuffer() = default;
+  virtual void Clear() = 0;
+};
+
+template <typename TEvent>
+class EventBuffer : public IEventBuffer {
+ public:
+  void Clear() override { events.clear(); }
+
+  std::vector<TEvent> events;
+};
+
+// Append-only event buffers for one producer, e.g. a system running on a
+// scheduler thread. Queueing touches only the queue's own per-type vectors,
+// so producers on different threads never wait for each other, and once the
+// vectors have grown to a frame's volume it does not allocate. Each queue
+// must be used by one thread at a time; EventBus::DispatchQueuedEvents
+// drains the queues in the order they were created, so handlers see the
+// same event order whatever the thread timing.
+class EventQueue {
+ public:
+  EventQueue() = default;
+  EventQueue(const EventQueue&) = delete;
+  EventQueue& operator=(const EventQueue&) = delete;
+
+  template <typename TEvent, typename... TArgs>
+  void Queue(TArgs&&... args) {
+    const size_t id = EventType<TEvent>::GetId();
+    if (id >= buffers.size()) {
+      buffers.resize(id + 1);
+    }
+    if (!buffers[id]) {
+      buffers[id] = std::make_unique<EventBuffer<TEvent>>();
+    }
+    static_cast<EventBuffer<TEvent>&>(*buffers[id])
+        .events.emplace_back(std::forward<TArgs>(args)...);
+  }
+
+  size_t GetBufferCount() const { return buffers.size(); }
+
+  // Returns nullptr if nothing of the type was ever queued here.
+  IEventBuffer* GetBuffer(size_t eventTypeId) const {
+    return eventTypeId < buffers.size() ? buffers[eventTypeId].get()
+                                        : nullptr;
+  }
+
+ private:
+  // Indexed by EventType<TEvent>::GetId().
+  std::vector<std::unique_ptr<IEventBuffer>> buffers;
+};
+
+typedef std::vector<std::unique_ptr<EventQueue>> EventQueueList;
+
+class IEventChannel {
+ public:
+  virtual ~IEventChannel() = default;
+  virtual void DispatchQueuedEvents(const EventQueueList& queues,
+                                    EventTracer* tracer) = 0;
+  virtual bool Unsubscribe(uint32_t id) = 0;
+  virtual void ClearHandlers() = 0;
+  virtual const char* GetEventName() const = 0;
+  // Appends what the channel saw since the last call, if anything, and
+  // starts counting afresh.
+  virtual void CollectTrace(EventTraceFrame& frame) = 0;
+};
+
+// Handlers of one event type. Queued events are gathered from every queue
+// into one contiguous batch whose capacity is kept from frame to frame, so
+// once it has grown to the busiest frame, dispatch allocates nothing.
+// Handlers may subscribe and unsubscribe while being called; removals take
+// effect at once and the slots are compacted when the outermost dispatch
+// ends. With a tracer, each handler call is counted and timed.
+template <typename TEvent>
+class EventChannel : public IEventChannel {
+ public:
+  template <typename TOwner>
+  uint32_t Subscribe(TOwner* owner, void (TOwner::*function)(TEvent&)) {
+    handlers.emplace_back(++lastId, owner, function);
+    return lastId;
+  }
+
+  template <typename TOwner>
+  uint32_t Subscribe(TOwner* owner,
+                     void (TOwner::*function)(EventSpan<TEvent>)) {
+    batchHandlers.emplace_back(++lastId, owner, function);
+    return lastId;
+  }
+
+  bool HasHandlers() const {
+    return !handlers.empty() || !batchHandlers.empty();
+  }
+
+  void Emit(TEvent& event, EventTracer* tracer) {
+    if (tracer) {
+      numEmitted++;
+    }
+    Dispatch(EventSpan<TEvent>(&event, 1), tracer);
+  }
+
+  // Events queued by the handlers wait for the next dispatch.
+  void DispatchQueuedEvents(const EventQueueList& queues,
+                            EventTracer* tracer) override {
+    const size_t id = EventType<TEvent>::GetId();
+    for (const auto& queue : queues) {
+      if (auto buffer = static_cast<EventBuffer<TEvent>*>(
+              queue->GetBuffer(id))) {
+        if (dispatchedEvents.empty()) {
+          std::swap(dispatchedEvents, buffer->events);
+        } else {
+          std::move(buffer->events.begin(), buffer->events.end(),
+                    std::back_inserter(dispatchedEvents));
+          buffer->events.clear();
+        }
+      }
+    }
+    if (dispatchedEvents.empty()) {
+      return;
+    }
+    if (tracer) {
+      numQueued += dispatchedEvents.size();
+    }
+    Dispatch(EventSpan<TEvent>(dispatchedEvents.data(),
+                               dispatchedEvents.size()),
+             tracer);
+    dispatchedEvents.clear();
+  }
+
+  bool Unsubscribe(uint32_t id) override {
+    return Remove(handlers, id) || Remove(batchHandlers, id);
+  }
+
+  void ClearHandlers() override {
+    for (auto& handler : handlers) {
+      handler.Disable();
+    }
+    for (auto& batchHandler : batchHandlers) {
+      batchHandler.Disable();
+    }
+    hasDisabledHandlers = true;
+    Compact();
+  }
+
+  const char* GetEventName() const override { return typeid(TEvent).name(); }
+
+  void CollectTrace(EventTraceFrame& frame) override {
+    EventTypeTrace trace;
+    trace.eventName = GetEventName();
+    trace.numEmitted = numEmitted;
+    trace.numQueued = numQueued;
+    CollectHandlerTraces(batchHandlers, trace);
+    CollectHandlerTraces(handlers, trace);
+    numEmitted = 0;
+    numQueued = 0;
+    if (trace.numEmitted > 0 || trace.numQueued > 0) {
+      frame.eventTypes.push_back(std::move(trace));
+    }
+  }
+
+ private:
+  // Batch handlers get the whole batch, then per-event handlers each event.
+  // Walks by index: handlers may subscribe more handlers.
+  void Dispatch(EventSpan<TEvent> events, EventTracer* tracer) {
+    if (tracer) {
+      DispatchTraced(events, *tracer);
+      return;
+    }
+    dispatchDepth++;
+    for (size_t i = 0; i < batchHandlers.size(); i++) {
+      if (batchHandlers[i].IsEnabled()) {
+        batchHandlers[i](events);
+      }
+    }
+    if (!handlers.empty()) {
+      for (auto& event : events) {
+        for (size_t i = 0; i < handlers.size(); i++) {
+          if (handlers[i].IsEnabled()) {
+            handlers[i](event);
+          }
+        }
+      }
+    }
+    dispatchDepth--;
+    Compact();
+  }
+
+  // Same order as Dispatch. The events are recorded before any handler can
+  // change them.
+  void DispatchTraced(EventSpan<TEvent> events, EventTracer& tracer) {
+    const auto eventTypeId = static_cast<uint32_t>(EventType<TEvent>::GetId());
+    for (const auto& event : events) {
+      tracer.Record(eventTypeId, event);
+    }
+    dispatchDepth++;
+    for (size_t i = 0; i < batchHandlers.size(); i++) {
+      if (batchHandlers[i].IsEnabled()) {
+        CallTraced(batchHandlers, i, events);
+      }
+    }
+    if (!handlers.empty()) {
+      for (auto& event : events) {
+        for (size_t i = 0; i < handlers.size(); i++) {
+          if (handlers[i].IsEnabled()) {
+            CallTraced<TEvent&>(handlers, i, event);
+          }
+        }
+      }
+    }
+    dispatchDepth--;
+    Compact();
+  }
+
+  // The handler may subscribe another and grow the vector, so the delegate
+  // is looked up again after the call.
+  template <typename TArgument>
+  static void CallTraced(std::vector<EventDelegate<TArgument>>& delegates,
+                         size_t index, TArgument argument) {
+    const auto start = std::chrono::steady_clock::now();
+    delegates[index](argument);
+    const auto end = std::chrono::steady_clock::now();
+    delegates[index].numCalls++;
+    delegates[index].callTime += end - start;
+  }
+
+  template <typename TDelegate>
+  static void CollectHandlerTraces(std::vector<TDelegate>& delegates,
+                                   EventTypeTrace& trace) {
+    for (auto& delegate : delegates) {
+      if (delegate.numCalls == 0) {
+        continue;
+      }
+      HandlerTrace handler;
+      handler.ownerName = delegate.GetOwnerName();
+      handler.subscriptionId = delegate.GetId();
+      handler.invocations = delegate.numCalls;
+      handler.milliseconds =
+          std::chrono::duration<double, std::milli>(delegate.callTime)
+              .count();
+      trace.handlers.push_back(std::move(handler));
+      delegate.numCalls = 0;
+      delegate.callTime = {};
+    }
+  }
+
+  template <typename TDelegate>
+  bool Remove(std::vector<TDelegate>& delegates, uint32_t id) {
+    for (auto& delegate : delegates) {
+      if (delegate.GetId() == id && delegate.IsEnabled()) {
+        delegate.Disable();
+        hasDisabledHandlers = true;
+        Compact();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Erases disabled handlers unless a dispatch is walking the vectors.
+  void Compact() {
+    if (dispatchDepth > 0 || !hasDisabledHandlers) {
+      return;
+    }
+    auto isDisabled = [](const auto& delegate) {
+      return !delegate.IsEnabled();
+    };
+    handlers.erase(
+        std::remove_if(handlers.begin(), handlers.end(), isDisabled),
+        handlers.end());
+    batchHandlers.erase(std::remove_if(batchHandlers.begin(),
+                                       batchHandlers.end(), isDisabled),
+                        batchHandlers.end());
+    hasDisabledHandlers = false;
+  }
+
+ private:
+  std::vector<EventDelegate<TEvent&>> handlers;
+  std::vector<EventDelegate<EventSpan<TEvent>>> batchHandlers;
+  uint32_t lastId = 0;
+  int dispatchDepth = 0;
+  bool hasDisabledHandlers = false;
+  std::vector<TEvent> dispatchedEvents;
+  // Counted only while tracing.
+  size_t numEmitted = 0;
+  size_t numQueued = 0;
+};
 
 class EventBus {
  public:
-  EventBus() { Logger::Log(LOG_CLASS_TAG, "contructor called"); };
+  EventBus() {
+    queues.push_back(std::make_unique<EventQueue>());
+    Logger::Log(LOG_CLASS_TAG, "contructor called");
+  };
   ~EventBus() { Logger::Log(LOG_CLASS_TAG, "destructor called"); };
 
-  void Reset() { subscribers.clear(); }
+  // Drops every subscription; queued events stay queued.
+  void Reset() {
+    for (auto& channel : channels) {
+      if (channel) {
+        channel->ClearHandlers();
+      }
+    }
+  }
 
+  // Subscriptions last until Unsubscribe or Reset, so subscribe once, e.g.
+  // when the subscribing system is added, not every frame. The owner must
+  // outlive the subscription.
   template <typename TEvent, typename TOwner>
-  void SubscribeToEvent(TOwner* ownerInstance,
-                        void (TOwner::*callbackFunction)(TEvent&)) {
-    if (!subscribers[typeid(TEvent)].get()) {
-      subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
-    }
-    auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(
-        ownerInstance, callbackFunction);
-    subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
+  SubscriptionHandle SubscribeToEvent(
+      TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&)) {
+    return SubscriptionHandle(
+        static_cast<uint32_t>(EventType<TEvent>::GetId()),
+        GetOrCreateChannel<TEvent>().Subscribe(ownerInstance,
+                                               callbackFunction));
+  }
+
+  // The callback receives each dispatch's queued events of the type as one
+  // batch; an event from EmitEvent comes as a batch of one.
+  template <typename TEvent, typename TOwner>
+  SubscriptionHandle SubscribeToEventBatch(
+      TOwner* ownerInstance,
+      void (TOwner::*callbackFunction)(EventSpan<TEvent>)) {
+    return SubscriptionHandle(
+        static_cast<uint32_t>(EventType<TEvent>::GetId()),
+        GetOrCreateChannel<TEvent>().Subscribe(ownerInstance,
+                                               callbackFunction));
+  }
+
+  // Returns false if the handle is invalid or already unsubscribed.
+  bool Unsubscribe(SubscriptionHandle handle) {
+    const size_t eventTypeId = handle.GetEventTypeId();
+    return handle.IsValid() && eventTypeId < channels.size() &&
+           channels[eventTypeId] &&
+           channels[eventTypeId]->Unsubscribe(handle.GetId());
   }
 
+  // Delivers the event right away. One event is built and shared by all
+  // handlers.
   template <typename TEvent, typename... TArgs>
   void EmitEvent(TArgs&&... args) {
-    auto handlers = subscribers[typeid(TEvent)].get();
-    if (handlers) {
-      for (auto it = handlers->begin(); it != handlers->end(); it++) {
-        auto handler = it->get();
-        TEvent event(std::forward<TArgs>(args)...);
-        handler->Execute(event);
+    auto channel = GetChannel<TEvent>();
+    if (channel && channel->HasHandlers()) {
+      TEvent event(std::forward<TArgs>(args)...);
+      channel->Emit(event, tracer.get());
+    }
+  }
+
+  // Appends the event to the bus's own queue until DispatchQueuedEvents,
+  // the cheap path for high-volume events such as collisions.
+  template <typename TEvent, typename... TArgs>
+  void QueueEvent(TArgs&&... args) {
+    queues.front()->template Queue<TEvent>(std::forward<TArgs>(args)...);
+  }
+
+  // A queue for a producer on another thread. Not thread-safe itself:
+  // create the queues up front, like command buffers, and hand one to each
+  // producer. They live as long as the bus.
+  EventQueue& CreateEventQueue() {
+    queues.push_back(std::make_unique<EventQueue>());
+    return *queues.back();
+  }
+
+  // Runs the handlers of all queued events, type by type in id order. Each
+  // type's batch holds the bus's own queue first, then the created queues
+  // in creation order. Call it at a sync point, when no producer is
+  // queueing. Everything but the EventQueues is for the main thread only.
+  void DispatchQueuedEvents() {
+    size_t numEventTypes = channels.size();
+    for (const auto& queue : queues) {
+      numEventTypes = std::max(numEventTypes, queue->GetBufferCount());
+    }
+    for (size_t id = 0; id < numEventTypes; id++) {
+      if (id < channels.size() && channels[id]) {
+        channels[id]->DispatchQueuedEvents(queues, tracer.get());
+        continue;
       }
+      // Nobody listens to this type.
+      for (const auto& queue : queues) {
+        if (auto buffer = queue->GetBuffer(id)) {
+          buffer->Clear();
+        }
+      }
+    }
+  }
+
+  // Tracing counts, per event type, the events emitted and dispatched from
+  // the queues and each handler's calls and time; with a nonzero
+  // recordingCapacity it also keeps the most recent trivially copyable
+  // events, up to that many bytes, for DumpRecordedEvents. It costs two
+  // clock reads per handler call, so leave it off unless looking.
+  void EnableTracing(size_t recordingCapacity = 0) {
+    tracer = std::make_unique<EventTracer>(recordingCapacity);
+  }
+
+  // Drops the counts of the unfinished frame along with the recording.
+  void DisableTracing() {
+    EndTraceFrame();
+    tracer.reset();
+  }
+
+  bool IsTracing() const { return tracer != nullptr; }
+
+  // Returns what was traced since the previous call and starts the next
+  // frame. Call it once per game frame, after DispatchQueuedEvents.
+  EventTraceFrame EndTraceFrame() {
+    EventTraceFrame frame;
+    if (!tracer) {
+      return frame;
+    }
+    frame.frame = tracer->GetFrame();
+    for (auto& channel : channels) {
+      if (channel) {
+        channel->CollectTrace(frame);
+      }
+    }
+    tracer->NextFrame();
+    return frame;
+  }
+
+  // The recorded events as a blob: the number of event types, each type's
+  // id and name, the number of records, then the records oldest first,
+  // each a uint32_t frame, event type id and payload size followed by the
+  // payload. Empty unless recording.
+  std::vector<uint8_t> DumpRecordedEvents() const {
+    std::vector<uint8_t> blob;
+    EventRecorder* recorder = tracer ? tracer->GetRecorder() : nullptr;
+    if (!recorder) {
+      return blob;
+    }
+    BinaryWriter writer(blob);
+    uint32_t numEventTypes = 0;
+    for (const auto& channel : channels) {
+      numEventTypes += channel != nullptr;
+    }
+    writer.Write(numEventTypes);
+    for (size_t id = 0; id < channels.size(); id++) {
+      if (channels[id]) {
+        writer.Write(static_cast<uint32_t>(id));
+        writer.WriteString(channels[id]->GetEventName());
+      }
+    }
+    writer.Write(static_cast<uint32_t>(recorder->GetRecordCount()));
+    const std::vector<uint8_t> records = recorder->Dump();
+    if (!records.empty()) {
+      writer.WriteBytes(records.data(), records.size());
+    }
+    return blob;
+  }
+
+ private:
+  template <typename TEvent>
+  EventChannel<TEvent>* GetChannel() const {
+    const size_t id = EventType<TEvent>::GetId();
+    if (id >= channels.size()) {
+      return nullptr;
+    }
+    return static_cast<EventChannel<TEvent>*>(channels[id].get());
+  }
+
+  template <typename TEvent>
+  EventChannel<TEvent>& GetOrCreateChannel() {
+    const size_t id = EventType<TEvent>::GetId();
+    if (id >= channels.size()) {
+      channels.resize(id + 1);
+    }
+    if (!channels[id]) {
+      channels[id] = std::make_unique<EventChannel<TEvent>>();
     }
+    return static_cast<EventChannel<TEvent>&>(*channels[id]);
   }
 
  private:
-  std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers;
+  // Indexed by EventType<TEvent>::GetId().
+  std::vector<std::unique_ptr<IEventChannel>> channels;
+  // The bus's own queue, then the created ones.
+  EventQueueList queues;
+  // Null unless tracing.
+  std::unique_ptr<EventTracer> tracer;
 };
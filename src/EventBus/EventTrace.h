@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// What one handler cost during a traced frame.
+struct HandlerTrace {
+  std::string ownerName;
+  uint32_t subscriptionId = 0;
+  size_t invocations = 0;
+  double milliseconds = 0;
+};
+
+// Volume of one event type during a traced frame: events delivered by
+// EmitEvent and events drained from the queues. Types without subscribers
+// are not traced.
+struct EventTypeTrace {
+  std::string eventName;
+  size_t numEmitted = 0;
+  size_t numQueued = 0;
+  std::vector<HandlerTrace> handlers;
+};
+
+// Returned by EventBus::EndTraceFrame.
+struct EventTraceFrame {
+  uint32_t frame = 0;
+  std::vector<EventTypeTrace> eventTypes;
+
+  size_t GetEventCount() const {
+    size_t count = 0;
+    for (const auto& eventType : eventTypes) {
+      count += eventType.numEmitted + eventType.numQueued;
+    }
+    return count;
+  }
+
+  double GetHandlerMilliseconds() const {
+    double milliseconds = 0;
+    for (const auto& eventType : eventTypes) {
+      for (const auto& handler : eventType.handlers) {
+        milliseconds += handler.milliseconds;
+      }
+    }
+    return milliseconds;
+  }
+
+  // One line per event type and per handler, for Logger::Log.
+  std::vector<std::string> Format() const {
+    std::vector<std::string> lines;
+    for (const auto& eventType : eventTypes) {
+      lines.push_back("frame " + std::to_string(frame) + " event " +
+                      eventType.eventName + ": " +
+                      std::to_string(eventType.numEmitted) + " emitted, " +
+                      std::to_string(eventType.numQueued) + " queued");
+      for (const auto& handler : eventType.handlers) {
+        lines.push_back("  handler " + handler.ownerName + " #" +
+                        std::to_string(handler.subscriptionId) + ": " +
+                        std::to_string(handler.invocations) + " calls, " +
+                        std::to_string(handler.milliseconds) + " ms");
+      }
+    }
+    return lines;
+  }
+};
+
+// Fixed-size ring of recorded event payloads. Each record is a header of
+// three uint32_t (frame, event type id, payload size) followed by the
+// payload's bytes; when the ring is full the oldest records are dropped.
+// Only trivially copyable events are recorded.
+class EventRecorder {
+ public:
+  explicit EventRecorder(size_t capacity) : bytes(capacity) {}
+
+  size_t GetRecordCount() const { return numRecords; }
+
+  template <typename TEvent>
+  void Record(uint32_t frame, uint32_t eventTypeId, const TEvent& event) {
+    if constexpr (std::is_trivially_copyable_v<TEvent>) {
+      const uint32_t header[3] = {frame, eventTypeId,
+                                  static_cast<uint32_t>(sizeof(TEvent))};
+      const size_t recordSize = sizeof(header) + sizeof(TEvent);
+      if (recordSize > bytes.size()) {
+        return;
+      }
+      while (used + recordSize > bytes.size()) {
+        DropOldest();
+      }
+      Write(header, sizeof(header));
+      Write(&event, sizeof(TEvent));
+      numRecords++;
+    }
+  }
+
+  // The records, oldest first, as one contiguous blob.
+  std::vector<uint8_t> Dump() const {
+    std::vector<uint8_t> blob(used);
+    if (used > 0) {
+      Read(head, blob.data(), used);
+    }
+    return blob;
+  }
+
+  void Clear() {
+    head = 0;
+    used = 0;
+    numRecords = 0;
+  }
+
+ private:
+  // Copies in at most two pieces, the second wrapping to the start.
+  void Write(const void* source, size_t size) {
+    const auto* sourceBytes = static_cast<const uint8_t*>(source);
+    const size_t position = (head + used) % bytes.size();
+    const size_t first = std::min(size, bytes.size() - position);
+    std::memcpy(bytes.data() + position, sourceBytes, first);
+    std::memcpy(bytes.data(), sourceBytes + first, size - first);
+    used += size;
+  }
+
+  void Read(size_t position, void* destination, size_t size) const {
+    auto* destinationBytes = static_cast<uint8_t*>(destination);
+    const size_t first = std::min(size, bytes.size() - position);
+    std::memcpy(destinationBytes, bytes.data() + position, first);
+    std::memcpy(destinationBytes + first, bytes.data(), size - first);
+  }
+
+  void DropOldest() {
+    uint32_t header[3];
+    Read(head, header, sizeof(header));
+    const size_t recordSize = sizeof(header) + header[2];
+    head = (head + recordSize) % bytes.size();
+    used -= recordSize;
+    numRecords--;
+  }
+
+ private:
+  std::vector<uint8_t> bytes;
+  size_t head = 0;
+  size_t used = 0;
+  size_t numRecords = 0;
+};
+
+// Tracing state shared by the channels of a traced EventBus.
+class EventTracer {
+ public:
+  explicit EventTracer(size_t recordingCapacity) {
+    if (recordingCapacity > 0) {
+      recorder = std::make_unique<EventRecorder>(recordingCapacity);
+    }
+  }
+
+  uint32_t GetFrame() const { return frame; }
+  void NextFrame() { frame++; }
+
+  EventRecorder* GetRecorder() const { return recorder.get(); }
+
+  template <typename TEvent>
+  void Record(uint32_t eventTypeId, const TEvent& event) {
+    if (recorder) {
+      recorder->Record(frame, eventTypeId, event);
+    }
+  }
+
+ private:
+  uint32_t frame = 0;
+  std::unique_ptr<EventRecorder> recorder;
+};
@@ -5,7 +5,7 @@
 
 class CollisionEvent : public Event {
  public:
-  Entity a;
-  Entity b;
-  CollisionEvent(Entity a, Entity b) : a(a), b(b) {}
+  EntityHandle a;
+  EntityHandle b;
+  CollisionEvent(EntityHandle a, EntityHandle b) : a(a), b(b) {}
 };
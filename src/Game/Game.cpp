@@ -10,6 +10,7 @@
 #include "../Components/CameraFollowComponent.h"
 #include "../Components/HealthComponent.h"
 #include "../Components/KeyboardControlledComponent.h"
+#include "../Components/ProjectileComponent.h"
 #include "../Components/ProjectileEmitterComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/SpriteComponent.h"
@@ -39,10 +40,12 @@ int Game::mapHeight;
 Game::Game() {
   Logger::Log(LOG_CLASS_TAG, "Game contructor called");
   registry = std::make_unique<Registry>();
+  scheduler = std::make_unique<SystemScheduler>();
   assetStore = std::make_unique<AssetStore>();
   eventBus = std::make_unique<EventBus>();
   isRunning = true;
   isDebug = false;
+  millisecsPreviousStatsDump = 0;
 }
 
 Game::~Game() { Logger::Log(LOG_CLASS_TAG, "Game destructor called"); }
@@ -94,19 +97,36 @@ void Game::Setup() { LoadLevel(1); }
 
 void Game::LoadLevel(int level) {
   Logger::Log(LOG_CLASS_TAG, "Setup()");
+  PrefabId projectilePrefab = registry->CreatePrefab();
+  registry->AddPrefabComponent<TransformComponent>(projectilePrefab);
+  registry->AddPrefabComponent<RigidBodyComponent>(projectilePrefab);
+  registry->AddPrefabComponent<SpriteComponent>(projectilePrefab,
+                                                "bullet-image", 4, 4, 4);
+  registry->AddPrefabComponent<BoxColliderComponent>(projectilePrefab, 4, 4);
+  registry->AddPrefabComponent<ProjectileComponent>(projectilePrefab);
+  registry->SetPrefabGroup(projectilePrefab, GetGroupId("projectiles"));
+
   registry->AddSystem<AnimationSystem>();
   registry->AddSystem<CameraMovementSystem>();
   registry->AddSystem<CollisionSystem>();
   registry->AddSystem<DamageSystem>();
   registry->AddSystem<KeyboardControlSystem>();
   registry->AddSystem<MovementSystem>();
-  registry->AddSystem<ProjectileEmitSystem>();
+  registry->AddSystem<ProjectileEmitSystem>(projectilePrefab);
   registry->AddSystem<ProjectileLifecycleSystem>();
   registry->AddSystem<RenderColliderSystem>();
   registry->AddSystem<RenderSystem>();
   registry->AddSystem<RenderHealthBarSystem>();
   registry->AddSystem<RenderTextSystem>();
 
+  // Subscriptions and event queues persist, so systems are wired to the bus
+  // once per level.
+  registry->GetSystem<CollisionSystem>().SetEventQueue(
+      eventBus->CreateEventQueue());
+  registry->GetSystem<DamageSystem>().SubscribeToEvents(eventBus);
+  registry->GetSystem<KeyboardControlSystem>().SubscribeToEvents(eventBus);
+  registry->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(eventBus);
+
   assetStore->AddTexture(renderer, "chopper-image",
                          "./assets/images/chopper-spritesheet.png");
   assetStore->AddTexture(renderer, "tank-image",
@@ -128,6 +148,14 @@ void Game::LoadLevel(int level) {
   int mapNumRows = 20;
   std::fstream mapFile;
   mapFile.open("./assets/tilemaps/jungle.map");
+  PrefabId tilePrefab = registry->CreatePrefab();
+  registry->AddPrefabComponent<TransformComponent>(
+      tilePrefab, glm::vec2(0), glm::vec2(tileScale, tileScale), 0.0);
+  registry->AddPrefabComponent<SpriteComponent>(tilePrefab, "tilemap-image", 0,
+                                                tileSize, tileSize);
+  registry->SetPrefabGroup(tilePrefab, GetGroupId("tiles"));
+  std::vector<Entity> tiles =
+      registry->InstantiateMany(tilePrefab, mapNumRows * mapNumCols);
   for (int y = 0; y < mapNumRows; y++) {
     for (int x = 0; x < mapNumCols; x++) {
       char ch;
@@ -137,13 +165,12 @@ void Game::LoadLevel(int level) {
       int srcRectX = std::atoi(&ch) * tileSize;
       mapFile.ignore();
 
-      Entity tile = registry->CreateEntity();
-      tile.Group("tiles");
-      tile.AddComponent<TransformComponent>(
-          glm::vec2(x * (tileScale * tileSize), y * (tileScale * tileSize)),
-          glm::vec2(tileScale, tileScale), 0.0);
-      tile.AddComponent<SpriteComponent>("tilemap-image", 0, tileSize, tileSize,
-                                         false, srcRectX, srcRectY);
+      Entity tile = tiles[y * mapNumCols + x];
+      tile.GetComponent<TransformComponent>().position =
+          glm::vec2(x * (tileScale * tileSize), y * (tileScale * tileSize));
+      auto& sprite = tile.GetComponent<SpriteComponent>();
+      sprite.srcRect.x = srcRectX;
+      sprite.srcRect.y = srcRectY;
     }
   }
   mapWidth = mapNumCols * tileSize * tileScale;
@@ -166,27 +193,24 @@ void Game::LoadLevel(int level) {
   chopper.AddComponent<ProjectileEmitterComponent>(glm::vec2(150.0, 150.0), 500,
                                                    10000, 30, true);
 
-  Entity tank = registry->CreateEntity();
-  tank.Group("enemies");
-  tank.AddComponent<TransformComponent>(glm::vec2(110.0, 500.0),
-                                        glm::vec2(1.0, 1.0), 0.0);
-  tank.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 0.0));
-  tank.AddComponent<SpriteComponent>("tank-image", 1, 32, 32);
-  tank.AddComponent<BoxColliderComponent>(32, 32);
-  tank.AddComponent<ProjectileEmitterComponent>(glm::vec2(50.0, 50.0), 2000,
-                                                5000, 10);
-  tank.AddComponent<HealthComponent>(100);
-
-  Entity truck = registry->CreateEntity();
-  truck.Group("enemies");
-  truck.AddComponent<TransformComponent>(glm::vec2(500.0, 450.0),
-                                         glm::vec2(1.0, 1.0), 0.0);
-  truck.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 0.0));
-  truck.AddComponent<SpriteComponent>("truck-image", 1, 32, 32);
-  truck.AddComponent<BoxColliderComponent>(32, 32);
-  truck.AddComponent<ProjectileEmitterComponent>(glm::vec2(-50.0, 50.0), 3000,
-                                                 5000, 10);
-  truck.AddComponent<HealthComponent>(100);
+  PrefabId enemyPrefab = registry->CreatePrefab();
+  registry->AddPrefabComponent<RigidBodyComponent>(enemyPrefab,
+                                                   glm::vec2(0.0, 0.0));
+  registry->AddPrefabComponent<BoxColliderComponent>(enemyPrefab, 32, 32);
+  registry->AddPrefabComponent<HealthComponent>(enemyPrefab, 100);
+  registry->SetPrefabGroup(enemyPrefab, GetGroupId("enemies"));
+
+  registry->Instantiate(
+      enemyPrefab,
+      TransformComponent(glm::vec2(110.0, 500.0), glm::vec2(1.0, 1.0), 0.0),
+      SpriteComponent("tank-image", 1, 32, 32),
+      ProjectileEmitterComponent(glm::vec2(50.0, 50.0), 2000, 5000, 10));
+
+  registry->Instantiate(
+      enemyPrefab,
+      TransformComponent(glm::vec2(500.0, 450.0), glm::vec2(1.0, 1.0), 0.0),
+      SpriteComponent("truck-image", 1, 32, 32),
+      ProjectileEmitterComponent(glm::vec2(-50.0, 50.0), 3000, 5000, 10));
 
   Entity radar = registry->CreateEntity();
   radar.AddComponent<TransformComponent>(glm::vec2(windowWidth - 70, 10.0),
@@ -213,6 +237,9 @@ void Game::ProcessInput() {
           isRunning = false;
         } else if (sdlEvent.key.keysym.sym == SDLK_d) {
           isDebug = !isDebug;
+          SetEventTracing(isDebug);
+        } else if (sdlEvent.key.keysym.sym == SDLK_r && isDebug) {
+          WriteEventRecording();
         }
         eventBus->EmitEvent<KeyPressedEvent>(sdlEvent.key.keysym.sym);
         break;
@@ -235,23 +262,97 @@ void Game::Update() {
   double deltaTime = (SDL_GetTicks() - millisecsPreviousFrame) / 1000.0;
   millisecsPreviousFrame = SDL_GetTicks();
 
-  // Perform the subscription of the events for all systems
-  eventBus->Reset();
-  registry->GetSystem<DamageSystem>().SubscribeToEvents(eventBus);
-  registry->GetSystem<KeyboardControlSystem>().SubscribeToEvents(eventBus);
-  registry->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(eventBus);
-
   // Update the registry to process the entities that are waiting to be
   // created/deleted
   registry->Update();
 
-  // Ask all the systems to update
-  registry->GetSystem<AnimationSystem>().Update();
-  registry->GetSystem<CameraMovementSystem>().Update(camera);
-  registry->GetSystem<CollisionSystem>().Update(eventBus);
-  registry->GetSystem<MovementSystem>().Update(deltaTime);
-  registry->GetSystem<ProjectileEmitSystem>().Update(registry);
-  registry->GetSystem<ProjectileLifecycleSystem>().Update();
+  // Ask all the systems to update. Steps run in this order unless their
+  // declared component access lets the scheduler overlap them.
+  auto& animationSystem = registry->GetSystem<AnimationSystem>();
+  scheduler->AddStep(animationSystem,
+                     [&]() { animationSystem.Update(registry); });
+  auto& projectileLifecycleSystem =
+      registry->GetSystem<ProjectileLifecycleSystem>();
+  scheduler->AddStep(projectileLifecycleSystem,
+                     [&]() { projectileLifecycleSystem.Update(); });
+  auto& cameraMovementSystem = registry->GetSystem<CameraMovementSystem>();
+  scheduler->AddStep(cameraMovementSystem,
+                     [&]() { cameraMovementSystem.Update(camera); });
+  auto& collisionSystem = registry->GetSystem<CollisionSystem>();
+  scheduler->AddStep(collisionSystem,
+                     [&]() { collisionSystem.Update(registry); });
+  auto& movementSystem = registry->GetSystem<MovementSystem>();
+  scheduler->AddStep(movementSystem,
+                     [&]() { movementSystem.Update(registry, deltaTime); });
+  auto& projectileEmitSystem = registry->GetSystem<ProjectileEmitSystem>();
+  scheduler->AddStep(projectileEmitSystem,
+                     [&]() { projectileEmitSystem.Update(registry); });
+  scheduler->Run();
+
+  // Collisions are queued by CollisionSystem and handled here in one batch.
+  eventBus->DispatchQueuedEvents();
+
+  if (eventBus->IsTracing()) {
+    EventTraceFrame traceFrame = eventBus->EndTraceFrame();
+    if (traceFrame.GetHandlerMilliseconds() >=
+        slowestTraceFrame.GetHandlerMilliseconds()) {
+      slowestTraceFrame = std::move(traceFrame);
+    }
+  }
+
+  if (SDL_GetTicks() - millisecsPreviousStatsDump >=
+      static_cast<Uint32>(MILLISECS_PER_STATS_DUMP)) {
+    LogRegistryStats();
+    LogEventTrace();
+    millisecsPreviousStatsDump = SDL_GetTicks();
+  }
+}
+
+void Game::LogRegistryStats() {
+  for (const auto& line : registry->GetStats().Format()) {
+    Logger::Log("Registry stats", line);
+  }
+}
+
+// Debug mode traces the event bus and records its events; leaving it logs
+// the slowest frame and drops the recording.
+void Game::SetEventTracing(bool isTracing) {
+  if (isTracing) {
+    eventBus->EnableTracing(EVENT_RECORDING_BYTES);
+    return;
+  }
+  LogEventTrace();
+  eventBus->DisableTracing();
+}
+
+void Game::SetEventRecordingPath(const std::string& path) {
+  eventRecordingPath = path;
+}
+
+void Game::WriteEventRecording() {
+  if (eventRecordingPath.empty()) {
+    Logger::Err(LOG_CLASS_TAG,
+                "No event recording path; start with --event-recording <path>");
+    return;
+  }
+  const std::vector<uint8_t> recording = eventBus->DumpRecordedEvents();
+  std::ofstream file(eventRecordingPath, std::ios::binary);
+  if (!file.write(reinterpret_cast<const char*>(recording.data()),
+                  recording.size())) {
+    Logger::Err(LOG_CLASS_TAG,
+                "Failed to write the event recording to " + eventRecordingPath);
+    return;
+  }
+  Logger::Log(LOG_CLASS_TAG, "Wrote " + std::to_string(recording.size()) +
+                                 " bytes of recorded events to " +
+                                 eventRecordingPath);
+}
+
+void Game::LogEventTrace() {
+  for (const auto& line : slowestTraceFrame.Format()) {
+    Logger::Log("Event trace", line);
+  }
+  slowestTraceFrame = EventTraceFrame();
 }
 
 void Game::Render() {
@@ -3,13 +3,18 @@
 #include <SDL2/SDL.h>
 
 #include <memory>
+#include <string>
 
 #include "../AssetStore/AssetStore.h"
 #include "../ECS/ECS.h"
+#include "../ECS/SystemScheduler.h"
 #include "../EventBus/EventBus.h"
 
 const int FPS = 60;
 const int MILLISECS_PER_FRAME = 1000 / FPS;
+const int MILLISECS_PER_STATS_DUMP = 10000;
+// Events kept while tracing in debug mode, for WriteEventRecording.
+const size_t EVENT_RECORDING_BYTES = 64 * 1024;
 
 class Game {
  public:
@@ -28,6 +33,13 @@ class Game {
   void ProcessInput();
   void Update();
   void Render();
+  void LogRegistryStats();
+  void SetEventTracing(bool isTracing);
+  void LogEventTrace();
+  // Where R, pressed in debug mode, writes the events recorded so far. Empty,
+  // the default, disables the dump.
+  void SetEventRecordingPath(const std::string& path);
+  void WriteEventRecording();
   void Destory();
 
  private:
@@ -37,9 +49,14 @@ class Game {
   std::unique_ptr<Registry> registry;
   std::unique_ptr<AssetStore> assetStore;
   std::unique_ptr<EventBus> eventBus;
+  std::unique_ptr<SystemScheduler> scheduler;
 
   bool isRunning;
   bool isDebug;
   SDL_Rect camera;
   int millisecsPreviousFrame;
+  int millisecsPreviousStatsDump;
+  // The frame with the most handler time since the last stats dump.
+  EventTraceFrame slowestTraceFrame;
+  std::string eventRecordingPath;
 };
@@ -3,10 +3,16 @@
 #include <chrono>
 #include <ctime>
 #include <iostream>
+#include <mutex>
 #include <string>
 
 std::vector<LogEntry> Logger::messages;
 
+namespace {
+// Systems may log from scheduler worker threads.
+std::mutex logMutex;
+}  // namespace
+
 std::string CurrentDateTimeToString() {
   std::time_t now =
       std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
@@ -17,6 +23,7 @@ std::string CurrentDateTimeToString() {
 }
 
 void Logger::Log(const std::string& tag, const std::string& message) {
+  std::lock_guard<std::mutex> lock(logMutex);
   LogEntry logEntry{LOG_INFO, "LOG: [" + CurrentDateTimeToString() + "] " +
                                   "<" + tag + "> : " + message};
   std::cout << "\x1B[32m" << logEntry.message << "\033[0m" << std::endl;
@@ -24,6 +31,7 @@ void Logger::Log(const std::string& tag, const std::string& message) {
 }
 
 void Logger::Err(const std::string& tag, const std::string& message) {
+  std::lock_guard<std::mutex> lock(logMutex);
   LogEntry logEntry{LOG_ERROR, "ERR: [" + CurrentDateTimeToString() + "] " +
                                    "<" + tag + "> : " + message};
   std::cout << "\x1B[91m" << logEntry.message << "\033[0m" << std::endl;
@@ -1,9 +1,20 @@
 #include <iostream>
+#include <string>
 
 #include "Game/Game.h"
 
-int main() {
+int main(int argc, char* argv[]) {
   Game game;
+  for (int i = 1; i < argc; i++) {
+    const std::string argument = argv[i];
+    if (argument == "--event-recording" && i + 1 < argc) {
+      game.SetEventRecordingPath(argv[++i]);
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--event-recording <path>]"
+                << std::endl;
+      return 1;
+    }
+  }
   game.Initialize();
   game.Run();
   game.Destory();
@@ -2,6 +2,8 @@
 
 #include <SDL2/SDL.h>
 
+#include <memory>
+
 #include "../Components/AnimationComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../ECS/ECS.h"
@@ -11,17 +13,17 @@ class AnimationSystem : public System {
   AnimationSystem() {
     RequireComponent<SpriteComponent>();
     RequireComponent<AnimationComponent>();
+    WritesComponent<SpriteComponent>();
+    WritesComponent<AnimationComponent>();
   }
 
-  void Update() {
-    for (auto entity : GetSystemEntities()) {
-      auto& animation = entity.GetComponent<AnimationComponent>();
-      auto& sprite = entity.GetComponent<SpriteComponent>();
-
-      animation.currentFrame = (SDL_GetTicks() - animation.startTime) *
-                               animation.frameRateSpeed / 1000 %
-                               animation.numFrames;
-      sprite.srcRect.x = animation.currentFrame * sprite.width;
-    }
+  void Update(std::unique_ptr<Registry>& registry) {
+    registry->View<AnimationComponent, SpriteComponent>().Each(
+        [](AnimationComponent& animation, SpriteComponent& sprite) {
+          animation.currentFrame = (SDL_GetTicks() - animation.startTime) *
+                                   animation.frameRateSpeed / 1000 %
+                                   animation.numFrames;
+          sprite.srcRect.x = animation.currentFrame * sprite.width;
+        });
   }
 };
@@ -12,11 +12,13 @@ class CameraMovementSystem : public System {
   CameraMovementSystem() {
     RequireComponent<CameraFollowComponent>();
     RequireComponent<TransformComponent>();
+    ReadsComponent<CameraFollowComponent>();
+    ReadsComponent<TransformComponent>();
   }
 
   void Update(SDL_Rect& camera) {
     for (auto entity : GetSystemEntities()) {
-      auto transform = entity.GetComponent<TransformComponent>();
+      auto transform = entity.ReadComponent<TransformComponent>();
       if (transform.position.x + camera.w / 2 < Game::mapWidth) {
         camera.x = transform.position.x - Game::windowWidth / 2;
       }
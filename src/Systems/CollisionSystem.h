@@ -2,41 +2,85 @@
 
 #include <glm/glm.hpp>
 #include <memory>
+#include <vector>
 
 #include "../Components/BoxColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
 #include "../EventBus/EventBus.h"
 #include "../Events/CollisionEvent.h"
-#include "Utils.h"
+#include "SpatialHash.h"
 
 class CollisionSystem : public System {
  public:
   CollisionSystem() {
     RequireComponent<TransformComponent>();
     RequireComponent<BoxColliderComponent>();
+    // Read-only, so the scheduler may overlap it with other readers.
+    ReadsComponent<TransformComponent>();
+    ReadsComponent<BoxColliderComponent>();
+    ReadsComponent<RigidBodyComponent>();
   }
 
-  void Update(std::unique_ptr<EventBus>& eventBus) {
-    auto entities = GetSystemEntities();
-    for (auto i = entities.begin(); i != entities.end(); i++) {
-      Entity a = *i;
-      auto aTransform = a.GetComponent<TransformComponent>();
-      auto aCollider = a.GetComponent<BoxColliderComponent>();
-      for (auto j = i + 1; j != entities.end(); j++) {
-        Entity b = *j;
-        if (a == b) continue;
-        auto bTransform = b.GetComponent<TransformComponent>();
-        auto bCollider = b.GetComponent<BoxColliderComponent>();
-        auto isCollides = CollisionUtil::CheckAABBCollision(
-            aTransform.position + aCollider.offset,
-            glm::vec2(aCollider.width, aCollider.height),
-            bTransform.position + bCollider.offset,
-            glm::vec2(bCollider.width, bCollider.height));
-        if (isCollides) {
-          eventBus->EmitEvent<CollisionEvent>(a, b);
-        }
-      }
+  // Collisions are queued here; Update may run on a scheduler thread.
+  void SetEventQueue(EventQueue& eventQueue) {
+    this->eventQueue = &eventQueue;
+  }
+
+  // Side of the broadphase grid's cells; 0, the default, sizes them from
+  // the colliders each frame.
+  void SetCellSize(float cellSize) { grid.SetCellSize(cellSize); }
+
+  // Collider pairs tested by the last Update.
+  size_t GetTestCount() const { return grid.GetTestCount(); }
+
+  void Update(std::unique_ptr<Registry>& registry) {
+    colliders.clear();
+    grid.Clear();
+    auto gather = [this](Entity entity, const TransformComponent& transform,
+                         const BoxColliderComponent& collider) {
+      colliders.push_back(entity.GetHandle());
+      grid.Insert(transform.position + collider.offset,
+                  glm::vec2(collider.width, collider.height));
+    };
+    movingColliders->Each([&gather](Entity entity,
+                                    const TransformComponent& transform,
+                                    const RigidBodyComponent&,
+                                    const BoxColliderComponent& collider) {
+      gather(entity, transform, collider);
+    });
+    registry
+        ->View<TransformComponent, BoxColliderComponent>(
+            Exclude<RigidBodyComponent>())
+        .Each(gather);
+
+    // Only colliders sharing a grid cell are tested. The pairs come in the
+    // order of a test of every pair, so events stay in the same order.
+    grid.Build();
+    collidingPairs.clear();
+    grid.FindOverlappingPairs(collidingPairs);
+    for (const auto& pair : collidingPairs) {
+      eventQueue->Queue<CollisionEvent>(colliders[pair.first],
+                                        colliders[pair.second]);
     }
   }
+
+ private:
+  void OnAdded() override {
+    movingColliders =
+        &GetRegistry()
+             ->GetComponentGroup<TransformComponent, RigidBodyComponent,
+                                 BoxColliderComponent>();
+  }
+
+ private:
+  // Resolved when the system is added, shared with MovementSystem.
+  ComponentGroup<TransformComponent, RigidBodyComponent,
+                 BoxColliderComponent>* movingColliders = nullptr;
+  // Indexed like the grid's boxes.
+  std::vector<EntityHandle> colliders;
+  SpatialHash grid;
+  std::vector<SpatialHash::Pair> collidingPairs;
+  EventQueue* eventQueue = nullptr;
 };
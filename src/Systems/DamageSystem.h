@@ -10,30 +10,45 @@
 
 class DamageSystem : public System {
  public:
-  DamageSystem() { RequireComponent<BoxColliderComponent>(); }
+  DamageSystem()
+      : playerTag(GetTagId("player")),
+        projectilesGroup(GetGroupId("projectiles")),
+        enemiesGroup(GetGroupId("enemies")) {
+    RequireComponent<BoxColliderComponent>();
+  }
 
   void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-    eventBus->SubscribeToEvent<CollisionEvent>(this,
-                                               &DamageSystem::OnCollision);
+    eventBus->SubscribeToEventBatch<CollisionEvent>(
+        this, &DamageSystem::OnCollisions);
+  }
+
+  void OnCollisions(EventSpan<CollisionEvent> events) {
+    for (auto& event : events) {
+      OnCollision(event);
+    }
   }
 
   void OnCollision(CollisionEvent& event) {
-    Entity a = event.a;
-    Entity b = event.b;
+    Registry* registry = GetRegistry();
+    if (!registry->IsAlive(event.a) || !registry->IsAlive(event.b)) {
+      return;
+    }
+    Entity a = registry->GetEntity(event.a);
+    Entity b = registry->GetEntity(event.b);
 
-    if (a.BelongsToGroup("projectiles") && b.HasTag("player")) {
+    if (a.BelongsToGroup(projectilesGroup) && b.HasTag(playerTag)) {
       OnProjectileHitsPlayer(a, b);
     }
 
-    if (b.BelongsToGroup("projectiles") && a.HasTag("player")) {
+    if (b.BelongsToGroup(projectilesGroup) && a.HasTag(playerTag)) {
       OnProjectileHitsPlayer(b, a);
     }
 
-    if (a.BelongsToGroup("projectiles") && b.BelongsToGroup("enemies")) {
+    if (a.BelongsToGroup(projectilesGroup) && b.BelongsToGroup(enemiesGroup)) {
       OnProjecttileHitsEnermy(a, b);
     }
 
-    if (b.BelongsToGroup("projectiles") && a.BelongsToGroup("enemies")) {
+    if (b.BelongsToGroup(projectilesGroup) && a.BelongsToGroup(enemiesGroup)) {
       OnProjecttileHitsEnermy(b, a);
     }
   }
@@ -41,7 +56,7 @@ class DamageSystem : public System {
   void Update() {}
 
   void OnProjectileHitsPlayer(Entity projectile, Entity player) {
-    auto projectileComponent = projectile.GetComponent<ProjectileComponent>();
+    auto projectileComponent = projectile.ReadComponent<ProjectileComponent>();
     if (!projectileComponent.isFriendly) {
       auto& health = player.GetComponent<HealthComponent>();
       health.healthPercentage -= projectileComponent.hitPercentDamage;
@@ -54,7 +69,7 @@ class DamageSystem : public System {
   }
 
   void OnProjecttileHitsEnermy(Entity projectile, Entity enermy) {
-    auto projectileComponent = projectile.GetComponent<ProjectileComponent>();
+    auto projectileComponent = projectile.ReadComponent<ProjectileComponent>();
     if (projectileComponent.isFriendly) {
       auto& health = enermy.GetComponent<HealthComponent>();
       health.healthPercentage -= projectileComponent.hitPercentDamage;
@@ -65,4 +80,9 @@ class DamageSystem : public System {
       projectile.Kill();
     }
   }
+
+ private:
+  TagId playerTag;
+  GroupId projectilesGroup;
+  GroupId enemiesGroup;
 };
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+
+#include "../Components/BoxColliderComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
@@ -9,14 +12,41 @@ class MovementSystem : public System {
   MovementSystem() {
     RequireComponent<TransformComponent>();
     RequireComponent<RigidBodyComponent>();
+    WritesComponent<TransformComponent>();
+    ReadsComponent<RigidBodyComponent>();
+    ReadsComponent<BoxColliderComponent>();
   }
 
-  void Update(double deltaTime) {
-    for (auto entity : GetSystemEntities()) {
-      auto& transform = entity.GetComponent<TransformComponent>();
-      const auto rigidbody = entity.GetComponent<RigidBodyComponent>();
+  void Update(std::unique_ptr<Registry>& registry, double deltaTime) {
+    auto integrate = [deltaTime](TransformComponent& transform,
+                                 const RigidBodyComponent& rigidbody) {
       transform.position.x += rigidbody.velocity.x * deltaTime;
       transform.position.y += rigidbody.velocity.y * deltaTime;
-    }
+    };
+
+    // Colliding movers walk the aligned front of the pools, the rest go
+    // through a regular view.
+    collidingMovers->Each([&integrate](TransformComponent& transform,
+                                       const RigidBodyComponent& rigidbody,
+                                       const BoxColliderComponent&) {
+      integrate(transform, rigidbody);
+    });
+    registry
+        ->View<TransformComponent, RigidBodyComponent>(
+            Exclude<BoxColliderComponent>())
+        .Each(integrate);
   }
+
+ private:
+  void OnAdded() override {
+    collidingMovers =
+        &GetRegistry()
+             ->GetComponentGroup<TransformComponent, RigidBodyComponent,
+                                 BoxColliderComponent>();
+  }
+
+ private:
+  // Resolved when the system is added, shared with CollisionSystem.
+  ComponentGroup<TransformComponent, RigidBodyComponent,
+                 BoxColliderComponent>* collidingMovers = nullptr;
 };
@@ -1,20 +1,28 @@
 #pragma once
 
-#include "../Components/BoxColliderComponent.h"
+#include "../Components/CameraFollowComponent.h"
 #include "../Components/ProjectileComponent.h"
 #include "../Components/ProjectileEmitterComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../Components/TransformComponent.h"
+#include "../ECS/CommandBuffer.h"
 #include "../ECS/ECS.h"
 #include "../EventBus/EventBus.h"
 #include "../Events/KeyPressedEvent.h"
 
 class ProjectileEmitSystem : public System {
  public:
-  ProjectileEmitSystem() {
+  // The prefab supplies everything a projectile has in common: sprite,
+  // collider and group. Position, velocity and damage are overridden per
+  // spawn.
+  ProjectileEmitSystem(PrefabId projectilePrefab)
+      : projectilePrefab(projectilePrefab) {
     RequireComponent<TransformComponent>();
     RequireComponent<ProjectileEmitterComponent>();
+    ReadsComponent<TransformComponent>();
+    ReadsComponent<SpriteComponent>();
+    WritesComponent<ProjectileEmitterComponent>();
   }
 
   void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
@@ -23,36 +31,33 @@ class ProjectileEmitSystem : public System {
   }
 
   void Update(std::unique_ptr<Registry>& registry) {
-    for (auto entity : GetSystemEntities()) {
-      if (entity.HasComponent<CameraFollowComponent>()) continue;
-      auto& projectileEmitter =
-          entity.GetComponent<ProjectileEmitterComponent>();
-      const auto transform = entity.GetComponent<TransformComponent>();
+    registry
+        ->View<TransformComponent, ProjectileEmitterComponent>(
+            Exclude<CameraFollowComponent>())
+        .Each([this](Entity entity, const TransformComponent& transform,
+                     ProjectileEmitterComponent& projectileEmitter) {
+          if (static_cast<int>(SDL_GetTicks()) -
+                  projectileEmitter.lastEmissionTime <
+              projectileEmitter.repeatFrequency)
+            return;
 
-      if (static_cast<int>(SDL_GetTicks()) -
-              projectileEmitter.lastEmissionTime <
-          projectileEmitter.repeatFrequency)
-        continue;
+          glm::vec2 projectilePosition = transform.position;
+          if (entity.HasComponent<SpriteComponent>()) {
+            const auto& sprite = entity.ReadComponent<SpriteComponent>();
+            projectilePosition.x += transform.scale.x * sprite.width / 2;
+            projectilePosition.y += transform.scale.y * sprite.height / 2;
+          }
 
-      glm::vec2 projectilePosition = transform.position;
-      if (entity.HasComponent<SpriteComponent>()) {
-        const auto sprite = entity.GetComponent<SpriteComponent>();
-        projectilePosition.x += transform.scale.x * sprite.width / 2;
-        projectilePosition.y += transform.scale.y * sprite.height / 2;
-      }
-      Entity projectile = registry->CreateEntity();
-      projectile.Group("projectiles");
-      projectile.AddComponent<TransformComponent>(projectilePosition,
-                                                  glm::vec2(1.0, 1.0), 0.0);
-      projectile.AddComponent<RigidBodyComponent>(
-          projectileEmitter.projectileVelocity);
-      projectile.AddComponent<SpriteComponent>("bullet-image", 4, 4, 4);
-      projectile.AddComponent<BoxColliderComponent>(4, 4);
-      projectile.AddComponent<ProjectileComponent>(
-          projectileEmitter.hitPercentDamage,
-          projectileEmitter.projectileDuration);
-      projectileEmitter.lastEmissionTime = SDL_GetTicks();
-    }
+          // Spawned through the command buffer so the system can run on a
+          // scheduler thread; the projectile appears at the next Update.
+          GetCommandBuffer().Instantiate(
+              projectilePrefab,
+              TransformComponent(projectilePosition, glm::vec2(1.0, 1.0), 0.0),
+              RigidBodyComponent(projectileEmitter.projectileVelocity),
+              ProjectileComponent(projectileEmitter.hitPercentDamage,
+                                  projectileEmitter.projectileDuration));
+          projectileEmitter.lastEmissionTime = SDL_GetTicks();
+        });
   }
 
   void OnKeyPressed(KeyPressedEvent& event) {
@@ -67,12 +72,12 @@ class ProjectileEmitSystem : public System {
               projectileEmitter.repeatFrequency)
             continue;
 
-          const auto transform = entity.GetComponent<TransformComponent>();
-          const auto rigidbody = entity.GetComponent<RigidBodyComponent>();
+          const auto transform = entity.ReadComponent<TransformComponent>();
+          const auto rigidbody = entity.ReadComponent<RigidBodyComponent>();
 
           glm::vec2 projectilePosition = transform.position;
           if (entity.HasComponent<SpriteComponent>()) {
-            auto sprite = entity.GetComponent<SpriteComponent>();
+            auto sprite = entity.ReadComponent<SpriteComponent>();
             projectilePosition.x += (transform.scale.x * sprite.width / 2);
             projectilePosition.y += (transform.scale.y * sprite.height / 2);
           }
@@ -89,19 +94,18 @@ class ProjectileEmitSystem : public System {
           projectileVelocity.y =
               projectileEmitter.projectileVelocity.y * directionY;
 
-          Entity projectile = entity.registry->CreateEntity();
-          projectile.Group("projectiles");
-          projectile.AddComponent<TransformComponent>(projectilePosition,
-                                                      glm::vec2(1.0, 1.0), 0);
-          projectile.AddComponent<RigidBodyComponent>(projectileVelocity);
-          projectile.AddComponent<SpriteComponent>("bullet-image", 4, 4, 4);
-          projectile.AddComponent<BoxColliderComponent>(4, 4);
-          projectile.AddComponent<ProjectileComponent>(
-              projectileEmitter.hitPercentDamage,
-              projectileEmitter.projectileDuration, true);
+          entity.registry->Instantiate(
+              projectilePrefab,
+              TransformComponent(projectilePosition, glm::vec2(1.0, 1.0), 0),
+              RigidBodyComponent(projectileVelocity),
+              ProjectileComponent(projectileEmitter.hitPercentDamage,
+                                  projectileEmitter.projectileDuration, true));
           projectileEmitter.lastEmissionTime = SDL_GetTicks();
         }
       }
     }
   }
+
+ private:
+  PrefabId projectilePrefab;
 };
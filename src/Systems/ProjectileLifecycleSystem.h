@@ -3,18 +3,24 @@
 #include <SDL2/SDL.h>
 
 #include "../Components/ProjectileComponent.h"
+#include "../ECS/CommandBuffer.h"
 #include "../ECS/ECS.h"
 
 class ProjectileLifecycleSystem : public System {
  public:
-  ProjectileLifecycleSystem() { RequireComponent<ProjectileComponent>(); }
+  // Kills go through the command buffer, so the system only reads
+  // components and can run on a scheduler thread.
+  ProjectileLifecycleSystem() {
+    RequireComponent<ProjectileComponent>();
+    ReadsComponent<ProjectileComponent>();
+  }
 
   void Update() {
     for (auto entity : GetSystemEntities()) {
-      auto projectile = entity.GetComponent<ProjectileComponent>();
+      auto projectile = entity.ReadComponent<ProjectileComponent>();
       if (static_cast<int>(SDL_GetTicks()) - projectile.startTime >
           projectile.duration) {
-        entity.Kill();
+        GetCommandBuffer().KillEntity(entity);
       }
     }
   }
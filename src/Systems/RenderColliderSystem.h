@@ -22,13 +22,13 @@ class RenderColliderSystem : public System {
     std::set<Entity> collidedEntities;
     for (auto i = entities.begin(); i != entities.end(); i++) {
       Entity a = *i;
-      auto aTransform = a.GetComponent<TransformComponent>();
-      auto aCollider = a.GetComponent<BoxColliderComponent>();
+      auto aTransform = a.ReadComponent<TransformComponent>();
+      auto aCollider = a.ReadComponent<BoxColliderComponent>();
       for (auto j = i + 1; j != entities.end(); j++) {
         Entity b = *j;
         if (a == b) continue;
-        auto bTransform = b.GetComponent<TransformComponent>();
-        auto bCollider = b.GetComponent<BoxColliderComponent>();
+        auto bTransform = b.ReadComponent<TransformComponent>();
+        auto bCollider = b.ReadComponent<BoxColliderComponent>();
         auto isCollides = CollisionUtil::CheckAABBCollision(
             aTransform.position + aCollider.offset,
             glm::vec2(aCollider.width, aCollider.height),
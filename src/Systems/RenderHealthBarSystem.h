@@ -20,9 +20,9 @@ class RenderHealthBarSystem : public System {
               const std::unique_ptr<AssetStore>& assetStore,
               const SDL_Rect& camera) {
     for (auto entity : GetSystemEntities()) {
-      const auto health = entity.GetComponent<HealthComponent>();
-      const auto sprit = entity.GetComponent<SpriteComponent>();
-      const auto transform = entity.GetComponent<TransformComponent>();
+      const auto health = entity.ReadComponent<HealthComponent>();
+      const auto sprit = entity.ReadComponent<SpriteComponent>();
+      const auto transform = entity.ReadComponent<TransformComponent>();
 
       SDL_Color healthBarColor = {255, 255, 255};
       if (health.healthPercentage >= 0 && health.healthPercentage < 40) {
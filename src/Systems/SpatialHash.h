@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+#include "Utils.h"
+
+// Uniform grid broadphase for axis-aligned boxes. Each box is entered in
+// every cell it touches and cells are hashed into a table of buckets, so
+// the grid needs no bounds; only boxes sharing a cell are tested against
+// each other. The grid is rebuilt from scratch by Clear, Insert and Build,
+// which is cheap next to the tests it saves, and its vectors keep their
+// capacity so a frame of the same size allocates nothing.
+class SpatialHash {
+ public:
+  // Indices of two overlapping boxes, in insertion order.
+  typedef std::pair<uint32_t, uint32_t> Pair;
+
+  // A cell size of 0 picks one at each Build: twice the mean extent of the
+  // boxes, so a typical box touches at most four cells.
+  explicit SpatialHash(float cellSize = 0) : configuredCellSize(cellSize) {}
+
+  void SetCellSize(float cellSize) { configuredCellSize = cellSize; }
+
+  // The cell size used by the last Build.
+  float GetCellSize() const { return cellSize; }
+
+  // Box-against-box tests made by the last FindOverlappingPairs.
+  size_t GetTestCount() const { return numTests; }
+
+  void Clear() { boxes.clear(); }
+
+  // Returns the box's index.
+  uint32_t Insert(glm::vec2 position, glm::vec2 size) {
+    boxes.push_back({position, size});
+    return static_cast<uint32_t>(boxes.size() - 1);
+  }
+
+  void Build() {
+    cellSize = configuredCellSize > 0 ? configuredCellSize : AutoCellSize();
+    inverseCellSize = 1.0f / cellSize;
+
+    ranges.clear();
+    size_t numEntries = 0;
+    for (const auto& box : boxes) {
+      const glm::ivec2 first = GetCell(box.position);
+      const glm::ivec2 last = GetCell(box.position + box.size);
+      ranges.push_back({first, last});
+      numEntries += static_cast<size_t>(last.x - first.x + 1) *
+                    static_cast<size_t>(last.y - first.y + 1);
+    }
+
+    // Counting sort of the entries into buckets: count, prefix sum, fill.
+    // Boxes are filled in order, so each bucket lists them by index.
+    size_t numBuckets = 16;
+    while (numBuckets < numEntries) {
+      numBuckets *= 2;
+    }
+    bucketMask = numBuckets - 1;
+    bucketStarts.assign(numBuckets + 1, 0);
+    ForEachEntry([this](glm::ivec2 cell, uint32_t) {
+      bucketStarts[GetBucket(cell) + 1]++;
+    });
+    for (size_t i = 1; i <= numBuckets; i++) {
+      bucketStarts[i] += bucketStarts[i - 1];
+    }
+    entries.resize(numEntries);
+    fillPositions.assign(bucketStarts.begin(), bucketStarts.end() - 1);
+    ForEachEntry([this](glm::ivec2 cell, uint32_t box) {
+      entries[fillPositions[GetBucket(cell)]++] = {cell, box};
+    });
+  }
+
+  // Appends every overlapping pair once, sorted by first then second index,
+  // which is the order a loop over all pairs would find them in. A pair is
+  // reported only from the cell holding the top-left corner of the overlap,
+  // the one cell both boxes are sure to share.
+  void FindOverlappingPairs(std::vector<Pair>& pairs) {
+    numTests = 0;
+    const size_t firstPair = pairs.size();
+    for (size_t bucket = 0; bucket + 1 < bucketStarts.size(); bucket++) {
+      const uint32_t end = bucketStarts[bucket + 1];
+      for (uint32_t i = bucketStarts[bucket]; i < end; i++) {
+        for (uint32_t j = i + 1; j < end; j++) {
+          // Different cells may hash to the same bucket.
+          if (entries[i].cell != entries[j].cell) {
+            continue;
+          }
+          numTests++;
+          const Box& a = boxes[entries[i].box];
+          const Box& b = boxes[entries[j].box];
+          if (CollisionUtil::CheckAABBCollision(a.position, a.size,
+                                                b.position, b.size) &&
+              GetCell(glm::max(a.position, b.position)) == entries[i].cell) {
+            pairs.emplace_back(entries[i].box, entries[j].box);
+          }
+        }
+      }
+    }
+    std::sort(pairs.begin() + firstPair, pairs.end());
+  }
+
+ private:
+  struct Box {
+    glm::vec2 position;
+    glm::vec2 size;
+  };
+
+  struct CellRange {
+    glm::ivec2 first;
+    glm::ivec2 last;
+  };
+
+  struct Entry {
+    glm::ivec2 cell;
+    uint32_t box;
+  };
+
+  float AutoCellSize() const {
+    if (boxes.empty()) {
+      return 1;
+    }
+    double extent = 0;
+    for (const auto& box : boxes) {
+      extent += std::max(box.size.x, box.size.y);
+    }
+    return std::max(1.0f, static_cast<float>(2 * extent / boxes.size()));
+  }
+
+  glm::ivec2 GetCell(glm::vec2 point) const {
+    return glm::ivec2(static_cast<int>(std::floor(point.x * inverseCellSize)),
+                      static_cast<int>(std::floor(point.y * inverseCellSize)));
+  }
+
+  size_t GetBucket(glm::ivec2 cell) const {
+    const uint32_t hash = static_cast<uint32_t>(cell.x) * 73856093u ^
+                          static_cast<uint32_t>(cell.y) * 19349663u;
+    return hash & bucketMask;
+  }
+
+  template <typename TFunction>
+  void ForEachEntry(TFunction function) const {
+    for (uint32_t box = 0; box < ranges.size(); box++) {
+      const CellRange& range = ranges[box];
+      for (int y = range.first.y; y <= range.last.y; y++) {
+        for (int x = range.first.x; x <= range.last.x; x++) {
+          function(glm::ivec2(x, y), box);
+        }
+      }
+    }
+  }
+
+ private:
+  float configuredCellSize;
+  float cellSize = 1;
+  float inverseCellSize = 1;
+  size_t bucketMask = 0;
+  size_t numTests = 0;
+  std::vector<Box> boxes;
+  std::vector<CellRange> ranges;
+  // Bucket b's entries are entries[bucketStarts[b]] up to
+  // entries[bucketStarts[b + 1]].
+  std::vector<uint32_t> bucketStarts;
+  std::vector<uint32_t> fillPositions;
+  std::vector<Entry> entries;
+};
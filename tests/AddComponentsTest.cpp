@@ -0,0 +1,43 @@
+// Checks that Registry::AddComponents signals like AddComponent. Build and
+// run with `make test`.
+
+#include <memory>
+#include <vector>
+
+#include "../src/ECS/ECS.h"
+#include "TestUtil.h"
+
+struct HealthComponent {
+  int health = 100;
+};
+
+void TestSignalsForExistingComponents() {
+  auto registry = std::make_unique<Registry>();
+  Entity existing = registry->CreateEntity();
+  Entity added = registry->CreateEntity();
+  existing.AddComponent<HealthComponent>();
+  registry->Update();
+
+  std::vector<Entity> constructed;
+  std::vector<Entity> updated;
+  registry->OnConstruct<HealthComponent>().Connect(
+      [&constructed](Entity entity) { constructed.push_back(entity); });
+  registry->OnUpdate<HealthComponent>().Connect(
+      [&updated](Entity entity) { updated.push_back(entity); });
+  registry->AddComponents(
+      {existing, added},
+      std::vector<HealthComponent>{HealthComponent{50}, HealthComponent{70}});
+
+  Check(constructed.size() == 1 && constructed[0] == added,
+        "onConstruct fires only for the entity without the component");
+  Check(updated.size() == 1 && updated[0] == existing,
+        "onUpdate fires for the entity that had the component");
+  Check(existing.GetComponent<HealthComponent>().health == 50,
+        "existing component is replaced");
+  Check(added.GetComponent<HealthComponent>().health == 70,
+        "new component is added");
+}
+
+int main() {
+  return RunTests("AddComponentsTest", {TestSignalsForExistingComponents});
+}
@@ -0,0 +1,125 @@
+// Checks that CollisionSystem runs alongside another event producer under
+// SystemScheduler and that both producers' events reach the handlers in
+// queue order. Build and run with `make test`.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../src/Components/BoxColliderComponent.h"
+#include "../src/Components/RigidBodyComponent.h"
+#include "../src/Components/TransformComponent.h"
+#include "../src/ECS/ECS.h"
+#include "../src/ECS/SystemScheduler.h"
+#include "../src/EventBus/EventBus.h"
+#include "../src/Events/CollisionEvent.h"
+#include "../src/Systems/CollisionSystem.h"
+#include "TestUtil.h"
+
+// Second producer: reports every entity with a transform as touching
+// itself, from its own queue.
+class SensorSystem : public System {
+ public:
+  SensorSystem() {
+    RequireComponent<TransformComponent>();
+    ReadsComponent<TransformComponent>();
+  }
+
+  void SetEventQueue(EventQueue& eventQueue) {
+    this->eventQueue = &eventQueue;
+  }
+
+  void Update() {
+    for (auto entity : GetSystemEntities()) {
+      eventQueue->Queue<CollisionEvent>(entity.GetHandle(),
+                                        entity.GetHandle());
+    }
+  }
+
+ private:
+  EventQueue* eventQueue = nullptr;
+};
+
+class CollisionRecorder {
+ public:
+  void OnCollision(CollisionEvent& event) { collisions.push_back(event); }
+
+  std::vector<CollisionEvent> collisions;
+};
+
+// Both steps wait here for the other; they only meet if the scheduler runs
+// them at the same time.
+class Rendezvous {
+ public:
+  void Arrive() {
+    numArrived++;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (numArrived < 2 && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    if (numArrived >= 2) {
+      numMet++;
+    }
+  }
+
+  bool HaveMet() const { return numMet == 2; }
+
+ private:
+  std::atomic<int> numArrived{0};
+  std::atomic<int> numMet{0};
+};
+
+void TestTwoProducersInOneFrame() {
+  auto registry = std::make_unique<Registry>();
+  auto eventBus = std::make_unique<EventBus>();
+  registry->AddSystem<CollisionSystem>();
+  registry->AddSystem<SensorSystem>();
+  auto& collisionSystem = registry->GetSystem<CollisionSystem>();
+  auto& sensorSystem = registry->GetSystem<SensorSystem>();
+  collisionSystem.SetEventQueue(eventBus->CreateEventQueue());
+  sensorSystem.SetEventQueue(eventBus->CreateEventQueue());
+  CollisionRecorder recorder;
+  eventBus->SubscribeToEvent<CollisionEvent>(&recorder,
+                                             &CollisionRecorder::OnCollision);
+
+  Entity mover = registry->CreateEntity();
+  mover.AddComponent<TransformComponent>(glm::vec2(0, 0));
+  mover.AddComponent<RigidBodyComponent>(glm::vec2(10, 0));
+  mover.AddComponent<BoxColliderComponent>(32, 32);
+  Entity wall = registry->CreateEntity();
+  wall.AddComponent<TransformComponent>(glm::vec2(16, 16));
+  wall.AddComponent<BoxColliderComponent>(32, 32);
+  registry->Update();
+
+  SystemScheduler scheduler(2);
+  Rendezvous rendezvous;
+  scheduler.AddStep(collisionSystem, [&]() {
+    rendezvous.Arrive();
+    collisionSystem.Update(registry);
+  });
+  scheduler.AddStep(sensorSystem, [&]() {
+    rendezvous.Arrive();
+    sensorSystem.Update();
+  });
+  scheduler.Run();
+  eventBus->DispatchQueuedEvents();
+
+  Check(rendezvous.HaveMet(), "collision and sensor systems overlap");
+  const auto& collisions = recorder.collisions;
+  Check(collisions.size() == 3, "both producers' events are dispatched");
+  if (collisions.size() == 3) {
+    Check(collisions[0].a == mover.GetHandle() &&
+              collisions[0].b == wall.GetHandle(),
+          "the collision queue, created first, is drained first");
+    Check(collisions[1].a == collisions[1].b &&
+              collisions[2].a == collisions[2].b,
+          "the sensor's events follow");
+  }
+}
+
+int main() {
+  return RunTests("CollisionSchedulingTest", {TestTwoProducersInOneFrame});
+}
@@ -0,0 +1,47 @@
+// Checks that CommandBuffer::Apply tolerates commands made stale by earlier
+// ones. Build and run with `make test`.
+
+#include <memory>
+
+#include "../src/ECS/CommandBuffer.h"
+#include "../src/ECS/ECS.h"
+#include "TestUtil.h"
+
+struct HealthComponent {
+  int health = 100;
+};
+
+void TestSameRemoveQueuedTwice() {
+  auto registry = std::make_unique<Registry>();
+  Entity entity = registry->CreateEntity();
+  entity.AddComponent<HealthComponent>();
+  registry->Update();
+
+  CommandBuffer& first = registry->CreateCommandBuffer();
+  CommandBuffer& second = registry->CreateCommandBuffer();
+  first.RemoveComponent<HealthComponent>(entity);
+  first.RemoveComponent<HealthComponent>(entity);
+  second.RemoveComponent<HealthComponent>(entity);
+  registry->Update();
+
+  Check(entity.IsAlive(), "entity survives the removes");
+  Check(!entity.HasComponent<HealthComponent>(), "component is removed");
+}
+
+void TestRemoveOfMissingComponent() {
+  auto registry = std::make_unique<Registry>();
+  Entity entity = registry->CreateEntity();
+  registry->Update();
+
+  CommandBuffer& buffer = registry->CreateCommandBuffer();
+  buffer.RemoveComponent<HealthComponent>(entity);
+  registry->Update();
+
+  Check(!entity.HasComponent<HealthComponent>(),
+        "removing a missing component is a no-op");
+}
+
+int main() {
+  return RunTests("CommandBufferTest",
+                  {TestSameRemoveQueuedTwice, TestRemoveOfMissingComponent});
+}
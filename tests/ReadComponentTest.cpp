@@ -0,0 +1,31 @@
+// Checks that Registry::ReadComponent does not count as a change. Build and
+// run with `make test`.
+
+#include <memory>
+
+#include "../src/ECS/ECS.h"
+#include "TestUtil.h"
+
+struct HealthComponent {
+  int health = 100;
+};
+
+void TestReadIsNotAChange() {
+  auto registry = std::make_unique<Registry>();
+  registry->EnableChangeTracking<HealthComponent>();
+  Entity entity = registry->CreateEntity();
+  entity.AddComponent<HealthComponent>();
+  registry->Update();
+  registry->Update();
+
+  const uint32_t tick = registry->GetTick();
+  Check(entity.ReadComponent<HealthComponent>().health == 100,
+        "read returns the component");
+  Check(!registry->WasChangedSince<HealthComponent>(entity, tick),
+        "read does not record a change");
+  entity.GetComponent<HealthComponent>();
+  Check(registry->WasChangedSince<HealthComponent>(entity, tick),
+        "GetComponent still records a change");
+}
+
+int main() { return RunTests("ReadComponentTest", {TestReadIsNotAChange}); }
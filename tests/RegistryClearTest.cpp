@@ -0,0 +1,53 @@
+// Checks that Registry::Clear unloads a level and that the registry can load
+// the next one. Build and run with `make test`.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/ECS/ECS.h"
+#include "TestUtil.h"
+
+struct PositionComponent {
+  float x = 0;
+  float y = 0;
+};
+
+struct NameComponent {
+  std::string name = "a name too long for the small string buffer";
+};
+
+// Fills the registry with a level's worth of entities and a prefab.
+void LoadLevel(Registry& registry, size_t numEntities) {
+  PrefabId prefab = registry.CreatePrefab();
+  registry.AddPrefabComponent<PositionComponent>(prefab);
+  registry.AddPrefabComponent<NameComponent>(prefab);
+  registry.InstantiateMany(prefab, numEntities);
+  registry.Update();
+}
+
+void TestClearReleasesArena() {
+  auto registry = std::make_unique<Registry>();
+  auto& group = registry->GetComponentGroup<PositionComponent>();
+  LoadLevel(*registry, 5000);
+  Check(group.GetSize() == 5000, "group holds the first level");
+  Check(registry->GetStats().arenaBytesReserved > 0, "arena holds chunks");
+
+  registry->Clear();
+  const RegistryStats stats = registry->GetStats();
+  Check(stats.numEntities == 0, "no entities after Clear");
+  Check(stats.numPrefabs == 0, "no prefabs after Clear");
+  Check(stats.arenaBytesReserved == 0, "arena released by Clear");
+  Check(group.GetSize() == 0, "group emptied by Clear");
+
+  LoadLevel(*registry, 300);
+  size_t numNamed = 0;
+  registry->View<PositionComponent, NameComponent>().Each(
+      [&numNamed](PositionComponent&, NameComponent& name) {
+        numNamed += !name.name.empty();
+      });
+  Check(numNamed == 300, "second level loads after Clear");
+  Check(group.GetSize() == 300, "group follows the second level");
+}
+
+int main() { return RunTests("RegistryClearTest", {TestClearReleasesArena}); }
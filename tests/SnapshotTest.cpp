@@ -0,0 +1,74 @@
+// Checks that Registry::Deserialize rejects corrupt snapshots. Build and run
+// with `make test`.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "../src/ECS/ECS.h"
+#include "TestUtil.h"
+
+// Trivially copyable, but its bool makes some bytes invalid, so it is
+// written field by field.
+struct DoorComponent {
+  int lockLevel = 0;
+  bool isOpen = false;
+};
+
+template <>
+struct ComponentSerializer<DoorComponent> {
+  static constexpr bool isSupported = true;
+
+  static void Write(BinaryWriter& writer, const DoorComponent& door) {
+    writer.Write(door.lockLevel);
+    writer.WriteBool(door.isOpen);
+  }
+
+  static void Read(BinaryReader& reader, DoorComponent& door) {
+    reader.Read(door.lockLevel);
+    reader.ReadBool(door.isOpen);
+  }
+};
+
+void TestRoundTrip() {
+  auto registry = std::make_unique<Registry>();
+  Entity entity = registry->CreateEntity();
+  entity.AddComponent<DoorComponent>(DoorComponent{3, true});
+  registry->Update();
+  const std::vector<uint8_t> blob = registry->Serialize();
+
+  auto loaded = std::make_unique<Registry>();
+  Check(loaded->Deserialize(blob), "snapshot loads");
+  Entity loadedEntity = loaded->GetEntity(entity.GetHandle());
+  Check(loadedEntity.HasComponent<DoorComponent>() &&
+            loadedEntity.GetComponent<DoorComponent>().isOpen &&
+            loadedEntity.GetComponent<DoorComponent>().lockLevel == 3,
+        "door survives the round trip");
+}
+
+void TestInvalidBool() {
+  auto registry = std::make_unique<Registry>();
+  Entity entity = registry->CreateEntity();
+  entity.AddComponent<DoorComponent>(DoorComponent{0x01020304, true});
+  registry->Update();
+  std::vector<uint8_t> blob = registry->Serialize();
+
+  // The bool is the byte after the lock level.
+  const uint8_t lockLevel[] = {0x04, 0x03, 0x02, 0x01};
+  bool isCorrupted = false;
+  for (size_t i = 0; i + sizeof(lockLevel) < blob.size(); i++) {
+    if (std::equal(lockLevel, lockLevel + sizeof(lockLevel), &blob[i]) &&
+        blob[i + sizeof(lockLevel)] == 1) {
+      blob[i + sizeof(lockLevel)] = 231;
+      isCorrupted = true;
+      break;
+    }
+  }
+  Check(isCorrupted, "found the bool in the snapshot");
+  auto loaded = std::make_unique<Registry>();
+  Check(!loaded->Deserialize(blob), "invalid bool fails the load");
+}
+
+int main() {
+  return RunTests("SnapshotTest", {TestRoundTrip, TestInvalidBool});
+}
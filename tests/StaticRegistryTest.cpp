@@ -0,0 +1,33 @@
+// Checks StaticRegistry's entity recycling. Build and run with `make test`.
+
+#include "../src/ECS/StaticRegistry.h"
+#include "TestUtil.h"
+
+struct PositionComponent {
+  int x = 0;
+};
+
+typedef StaticRegistry<TypeList<PositionComponent>, TypeList<>> World;
+
+void TestDuplicateKillFreesIdOnce() {
+  World world;
+  EntityHandle entity = world.CreateEntity();
+  world.AddComponent<PositionComponent>(entity);
+  world.KillEntity(entity);
+  world.KillEntity(entity);
+  world.Update();
+
+  Check(!world.IsAlive(entity), "killed entity is dead");
+  EntityHandle first = world.CreateEntity();
+  EntityHandle second = world.CreateEntity();
+  Check(first.GetIndex() != second.GetIndex(),
+        "a doubly killed id is recycled once");
+  Check(world.IsAlive(first) && world.IsAlive(second),
+        "both new entities are alive");
+  Check(!world.HasComponent<PositionComponent>(first),
+        "recycled id starts without components");
+}
+
+int main() {
+  return RunTests("StaticRegistryTest", {TestDuplicateKillFreesIdOnce});
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+// Shared by the tests in this directory. Each test file is its own program
+// (see `make test`), so the failure count belongs to one test.
+inline int numFailures = 0;
+
+// Records a failure and carries on, so one run reports every broken check.
+inline void Check(bool condition, const std::string& description) {
+  if (!condition) {
+    std::cerr << "FAILED: " << description << std::endl;
+    numFailures++;
+  }
+}
+
+// Runs the tests with std::cout silenced, since the registry logs every
+// structural change, then prints "<testName> passed" or "<testName> failed"
+// and returns main's exit code.
+inline int RunTests(const std::string& testName,
+                    std::initializer_list<void (*)()> tests) {
+  std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+  for (auto test : tests) {
+    test();
+  }
+  std::cout.rdbuf(coutBuffer);
+  std::cout << testName << (numFailures == 0 ? " passed" : " failed")
+            << std::endl;
+  return numFailures == 0 ? 0 : 1;
+}